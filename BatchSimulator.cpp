@@ -0,0 +1,235 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+/*
+*   Headless batch of landings for controller tuning. Every episode is a new
+*   planet generated from its own seed (first seed + episode number), flown by
+*   the chosen input policy until the rocket lands, crashes, leaves the world
+*   or runs out of steps. Episodes are independent and shared between all
+*   threads, every thread keeps its own simulation.
+*
+*   Usage: batch_simulator [--episodes N] [--threads N] [--seed N] [--policy idle|random|descent]
+*                          [--dt SECONDS] [--max-steps N]
+*/
+
+namespace
+{
+    constexpr size_t World_width  = 1024;
+    constexpr size_t World_height = 768;
+
+    struct Options
+    {
+        size_t episodes   = 10000;
+        size_t threads    = WorkStealingPool::get_default_threads_count();
+        uint32_t seed     = Planet::Default_seed;
+        std::string policy = "descent";
+        float dt          = 1.0f / 60;
+        size_t max_steps  = 10000;
+    };
+
+    // Per thread results, padded so that the threads do not write into one cache line
+    struct alignas(64) Statistics
+    {
+        size_t landed    = 0;
+        size_t crashed   = 0;
+        size_t lost      = 0;
+        size_t timed_out = 0;
+        size_t steps     = 0;
+
+        void add(const Statistics &other)
+        {
+            landed    += other.landed;
+            crashed   += other.crashed;
+            lost      += other.lost;
+            timed_out += other.timed_out;
+            steps     += other.steps;
+        }
+
+        size_t get_episodes() const
+        {
+            return landed + crashed + lost + timed_out;
+        }
+    };
+
+    //----------------------------------------------------------------
+    // Input policies
+    //----------------------------------------------------------------
+
+    // Keeps the rocket upright and holds the descent speed, roughly what a careful player does
+    void descent_policy(Rocket &rocket, double)
+    {
+        static constexpr double Descent_speed = 5;
+
+        rocket.toggle_rcs(Rocket::RcsEngineMode::STABILIZE);
+        rocket.toggle_engine(rocket.get_velocity().y > Descent_speed ? Rocket::EngineMode::INCREASE_THRUST
+                                                                     : Rocket::EngineMode::DECREASE_THRUST);
+    }
+
+    // Presses and releases keys at random moments, seeded with the episode seed
+    Simulation::InputPolicy make_random_policy(uint32_t seed)
+    {
+        return [random = std::mt19937(seed)](Rocket &rocket, double) mutable
+        {
+            static constexpr double Switch_probability = 0.05;
+
+            std::uniform_real_distribution<double> chance(0, 1);
+            if (chance(random) < Switch_probability)
+            {
+                static constexpr Rocket::EngineMode Engine_modes[] = {
+                    Rocket::EngineMode::IDLE, Rocket::EngineMode::INCREASE_THRUST, Rocket::EngineMode::DECREASE_THRUST
+                };
+                rocket.toggle_engine(Engine_modes[random() % std::size(Engine_modes)]);
+            }
+
+            if (chance(random) < Switch_probability)
+            {
+                static constexpr Rocket::RcsEngineMode Rcs_modes[] = {
+                    Rocket::RcsEngineMode::CW, Rocket::RcsEngineMode::CCW, Rocket::RcsEngineMode::STABILIZE
+                };
+                rocket.toggle_rcs(Rcs_modes[random() % std::size(Rcs_modes)]);
+            }
+        };
+    }
+
+    bool make_policy(const std::string &name, uint32_t seed, Simulation::InputPolicy &policy)
+    {
+        if (name == "idle")
+            policy = nullptr;
+        else if (name == "descent")
+            policy = descent_policy;
+        else if (name == "random")
+            policy = make_random_policy(seed);
+        else
+            return false;
+
+        return true;
+    }
+
+    //----------------------------------------------------------------
+    // Command line
+    //----------------------------------------------------------------
+
+    void print_usage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--episodes N] [--threads N] [--seed N]"
+                                             " [--policy idle|random|descent] [--dt SECONDS] [--max-steps N]\n";
+    }
+
+    bool parse_options(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            if (i + 1 >= argc)
+                return false;
+
+            const char *name  = argv[i];
+            const char *value = argv[i + 1];
+            if (std::strcmp(name, "--episodes") == 0)
+                options.episodes = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--threads") == 0)
+                options.threads = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--seed") == 0)
+                options.seed = std::strtoul(value, nullptr, 10);
+            else if (std::strcmp(name, "--policy") == 0)
+                options.policy = value;
+            else if (std::strcmp(name, "--dt") == 0)
+                options.dt = std::strtof(value, nullptr);
+            else if (std::strcmp(name, "--max-steps") == 0)
+                options.max_steps = std::strtoull(value, nullptr, 10);
+            else
+                return false;
+        }
+
+        Simulation::InputPolicy policy;
+        return options.threads > 0 && options.dt > 0 && make_policy(options.policy, 0, policy);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    WorkStealingPool pool(options.threads);
+
+    // Created here and not by the workers: Rocket's constructor calls rand(), which is not thread-safe
+    std::vector<std::unique_ptr<Simulation>> simulations(pool.get_threads_count());
+    for (std::unique_ptr<Simulation> &simulation : simulations)
+        simulation = std::make_unique<Simulation>(World_width, World_height);
+
+    std::vector<Statistics> statistics(pool.get_threads_count());
+
+    // Small chunks keep the threads busy till the end, episodes are long enough to hide the stealing
+    static constexpr size_t Episodes_per_chunk = 4;
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallel_for(options.episodes, Episodes_per_chunk, [&](size_t begin, size_t end, size_t worker_id)
+    {
+        std::unique_ptr<Simulation> &simulation = simulations[worker_id];
+        Statistics &result = statistics[worker_id];
+        for (size_t episode = begin; episode < end; ++episode)
+        {
+            uint32_t seed = options.seed + static_cast<uint32_t>(episode);
+
+            Simulation::InputPolicy policy;
+            make_policy(options.policy, seed, policy);
+
+            switch (simulation->run_episode(seed, policy, options.dt, options.max_steps))
+            {
+                case Rocket::RocketState::LANDED:
+                {
+                    ++result.landed;
+                    break;
+                }
+                case Rocket::RocketState::CRASHED:
+                {
+                    ++result.crashed;
+                    break;
+                }
+                case Rocket::RocketState::IN_FLIGHT:
+                {
+                    if (simulation->is_rocket_outside())
+                        ++result.lost;
+                    else
+                        ++result.timed_out;
+                    break;
+                }
+            }
+
+            result.steps += simulation->get_steps_count();
+        }
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    Statistics total;
+    for (const Statistics &result : statistics)
+        total.add(result);
+
+    double seconds = elapsed.count();
+    std::cout << "threads:       " << pool.get_threads_count() << '\n'
+              << "episodes:      " << total.get_episodes() << " (landed "  << total.landed
+                                                           << ", crashed "   << total.crashed
+                                                           << ", lost "      << total.lost
+                                                           << ", timed out " << total.timed_out << ")\n"
+              << "sim steps:     " << total.steps << '\n'
+              << "time:          " << seconds << " s\n"
+              << "episodes/sec:  " << total.get_episodes() / seconds << '\n'
+              << "sim steps/sec: " << total.steps / seconds << '\n';
+
+    return EXIT_SUCCESS;
+}
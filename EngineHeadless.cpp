@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+#include "Game.h"
+#include "HeadlessEngine.h"
+
+/*
+*   Runs the game without a display. The clock is synthetic (every frame is
+*   dt seconds long) and the keys are pressed by a script, so two runs with
+*   the same options draw the same frames on any machine. Frames are written
+*   as PPM images or appended to a raw stream of 32 bit BGRX pixels, which
+*   ffmpeg reads with -f rawvideo -pixel_format bgr0 -video_size 1024x768.
+*
+*   Script lines are "FRAME press|release KEY", "FRAME dump" or "FRAME quit",
+*   keys are escape, space, left, up, right, down and return. Key changes are
+*   applied before act() of the frame, dumps are written after its draw().
+*
+*   Usage: game_headless [--frames N] [--dt SECONDS] [--seed N] [--script FILE]
+*                        [--dump-every N] [--ppm DIRECTORY] [--raw FILE] [--prediction on|off]
+*/
+
+namespace
+{
+    struct Options
+    {
+        size_t frames      = 600;
+        float dt           = 1.0f / 60;
+        uint32_t seed      = 0;
+        std::string script;
+        size_t dump_every  = 0;
+        std::string ppm_directory;
+        std::string raw_path;
+        bool is_prediction_enabled = false;
+    };
+
+    struct ScriptCommand
+    {
+        enum class Type
+        {
+            PRESS,
+            RELEASE,
+            DUMP,
+            QUIT,
+        };
+
+        size_t frame = 0;
+        Type type    = Type::DUMP;
+        int key      = 0;
+    };
+
+    //----------------------------------------------------------------
+    // Script
+    //----------------------------------------------------------------
+
+    bool parse_key(const std::string &name, int &key)
+    {
+        static constexpr const char *Key_names[VK__COUNT] = {
+            "escape", "space", "left", "up", "right", "down", "return"
+        };
+
+        for (int key_id = 0; key_id < VK__COUNT; ++key_id)
+        {
+            if (name == Key_names[key_id])
+            {
+                key = key_id;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parse_command(const std::string &line, ScriptCommand &command)
+    {
+        std::istringstream stream(line);
+        std::string action;
+        if (!(stream >> command.frame >> action))
+            return false;
+
+        if (action == "dump")
+            command.type = ScriptCommand::Type::DUMP;
+        else if (action == "quit")
+            command.type = ScriptCommand::Type::QUIT;
+        else
+        {
+            if (action == "press")
+                command.type = ScriptCommand::Type::PRESS;
+            else if (action == "release")
+                command.type = ScriptCommand::Type::RELEASE;
+            else
+                return false;
+
+            std::string key_name;
+            if (!(stream >> key_name) || !parse_key(key_name, command.key))
+                return false;
+        }
+
+        std::string rest;
+        return !(stream >> rest);
+    }
+
+    // Empty lines and lines starting with # are skipped, commands are sorted by frame
+    bool read_script(const std::string &path, std::vector<ScriptCommand> &commands)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "Can't read the script " << path << '\n';
+            return false;
+        }
+
+        std::string line;
+        for (size_t line_number = 1; std::getline(file, line); ++line_number)
+        {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;
+
+            ScriptCommand command;
+            if (!parse_command(line, command))
+            {
+                std::cerr << path << ':' << line_number << ": bad command \"" << line << "\"\n";
+                return false;
+            }
+            commands.push_back(command);
+        }
+
+        std::stable_sort(commands.begin(), commands.end(), [](const ScriptCommand &lhs, const ScriptCommand &rhs)
+        {
+            return lhs.frame < rhs.frame;
+        });
+        return true;
+    }
+
+    //----------------------------------------------------------------
+    // Frame dumps
+    //----------------------------------------------------------------
+
+    bool write_ppm(const std::string &directory, size_t frame)
+    {
+        char name[32] = {};
+        std::snprintf(name, sizeof(name), "/frame_%06zu.ppm", frame);
+
+        std::ofstream file(directory + name, std::ios::binary);
+        if (!file)
+            return false;
+
+        file << "P6\n" << SCREEN_WIDTH << ' ' << SCREEN_HEIGHT << "\n255\n";
+
+        std::vector<char> row(SCREEN_WIDTH * 3);
+        for (size_t y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            for (size_t x = 0; x < SCREEN_WIDTH; ++x)
+            {
+                uint32_t pixel = buffer[y][x];
+                row[3 * x + 0] = static_cast<char>(pixel >> 16);
+                row[3 * x + 1] = static_cast<char>(pixel >> 8);
+                row[3 * x + 2] = static_cast<char>(pixel);
+            }
+            file.write(row.data(), row.size());
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool write_raw(std::ofstream &stream)
+    {
+        stream.write(reinterpret_cast<const char *>(buffer), sizeof(buffer));
+        return static_cast<bool>(stream);
+    }
+
+    //----------------------------------------------------------------
+    // Command line
+    //----------------------------------------------------------------
+
+    void print_usage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--frames N] [--dt SECONDS] [--seed N] [--script FILE]"
+                                             " [--dump-every N] [--ppm DIRECTORY] [--raw FILE]"
+                                             " [--prediction on|off]\n";
+    }
+
+    bool parse_options(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            if (i + 1 >= argc)
+                return false;
+
+            const char *name  = argv[i];
+            const char *value = argv[i + 1];
+            if (std::strcmp(name, "--frames") == 0)
+                options.frames = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--dt") == 0)
+                options.dt = std::strtof(value, nullptr);
+            else if (std::strcmp(name, "--seed") == 0)
+                options.seed = std::strtoul(value, nullptr, 10);
+            else if (std::strcmp(name, "--script") == 0)
+                options.script = value;
+            else if (std::strcmp(name, "--dump-every") == 0)
+                options.dump_every = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--ppm") == 0)
+                options.ppm_directory = value;
+            else if (std::strcmp(name, "--raw") == 0)
+                options.raw_path = value;
+            else if (std::strcmp(name, "--prediction") == 0 && std::strcmp(value, "on") == 0)
+                options.is_prediction_enabled = true;
+            else if (std::strcmp(name, "--prediction") == 0 && std::strcmp(value, "off") == 0)
+                options.is_prediction_enabled = false;
+            else
+                return false;
+        }
+
+        return options.dt > 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ScriptCommand> script;
+    if (!options.script.empty() && !read_script(options.script, script))
+        return EXIT_FAILURE;
+
+    std::ofstream raw_stream;
+    if (!options.raw_path.empty())
+    {
+        raw_stream.open(options.raw_path, std::ios::binary);
+        if (!raw_stream)
+        {
+            std::cerr << "Can't write the frames to " << options.raw_path << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The prediction overlay is timing dependent, keep it off for golden images
+    set_session_seed(options.seed);
+    set_prediction_enabled(options.is_prediction_enabled);
+    set_recording_enabled(false);
+    initialize();
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration act_time{};
+    Clock::duration draw_time{};
+
+    size_t frames_count = 0;
+    size_t dumps_count  = 0;
+    auto command = script.begin();
+
+    // Same order of calls as in Engine.cpp
+    for (size_t frame = 0; frame < options.frames && !is_quit_scheduled(); ++frame)
+    {
+        bool is_dump_requested = options.dump_every > 0 && frame % options.dump_every == 0;
+        for (; command != script.end() && command->frame == frame; ++command)
+        {
+            switch (command->type)
+            {
+                case ScriptCommand::Type::PRESS:
+                {
+                    set_key_pressed(command->key, true);
+                    break;
+                }
+                case ScriptCommand::Type::RELEASE:
+                {
+                    set_key_pressed(command->key, false);
+                    break;
+                }
+                case ScriptCommand::Type::DUMP:
+                {
+                    is_dump_requested = true;
+                    break;
+                }
+                case ScriptCommand::Type::QUIT:
+                {
+                    schedule_quit_game();
+                    break;
+                }
+            }
+        }
+
+        auto act_start = Clock::now();
+        act(options.dt);
+        act_time += Clock::now() - act_start;
+
+        if (is_quit_scheduled())
+            break;
+
+        auto draw_start = Clock::now();
+        draw();
+        draw_time += Clock::now() - draw_start;
+        ++frames_count;
+
+        if (!is_dump_requested)
+            continue;
+
+        if (!options.ppm_directory.empty() && !write_ppm(options.ppm_directory, frame))
+        {
+            std::cerr << "Can't write frame " << frame << " to " << options.ppm_directory << '\n';
+            break;
+        }
+        if (raw_stream.is_open() && !write_raw(raw_stream))
+        {
+            std::cerr << "Can't write frame " << frame << " to " << options.raw_path << '\n';
+            break;
+        }
+        ++dumps_count;
+    }
+
+    finalize();
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    double act_ms  = std::chrono::duration_cast<Milliseconds>(act_time).count();
+    double draw_ms = std::chrono::duration_cast<Milliseconds>(draw_time).count();
+    double frames  = std::max<size_t>(frames_count, 1);
+
+    std::cout << "seed:        " << options.seed << '\n'
+              << "frames:      " << frames_count << " (dumped " << dumps_count << ")\n"
+              << "game time:   " << frames_count * options.dt << " s\n"
+              << "act:         " << act_ms  / frames << " ms/frame\n"
+              << "draw:        " << draw_ms / frames << " ms/frame\n"
+              << "frame hash:  " << std::hex << hash_frame() << std::dec << '\n';
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,412 @@
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XShm.h>
+#include <sched.h>
+#include <sys/ipc.h>
+#include <sys/mman.h>
+#include <sys/shm.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "Engine.h"
+#include "Game.h"
+
+/*
+*   Engine.cpp with another way to show the frames. Engine.cpp sends the whole
+*   buffer over the X socket every frame and copies it once more from a pixmap.
+*   Here the pages of buffer are replaced by a shared memory segment (MIT-SHM),
+*   so the X server reads the frame right where the game draws it, and only
+*   the areas repainted by the last draw() are put to the window. The server
+*   reports a finished put with a ShmCompletion event, the next draw() waits
+*   for it so that the server never reads a half drawn frame.
+*
+*   Without the extension (or on a remote display) the damaged areas are sent
+*   with XPutImage. LANDER_NO_SHM=1 forces this path.
+*
+*   Not yet run against an X server: it builds, but neither path has been
+*   checked on a display, Xvfb included.
+*/
+
+// Page aligned, shmat can put the segment right at its address
+alignas(4096) uint32_t buffer[SCREEN_HEIGHT][SCREEN_WIDTH] = {};
+
+namespace
+{
+    bool keys[VK__COUNT] = {};
+
+    Display *display = nullptr;
+    Window window;
+    Visual *visual = nullptr;
+    GC gc = 0;
+    int screen = 0;
+    bool quit = false;
+    Atom wm_delete_message = 0;
+    XClassHint *classhint = nullptr;
+    XWMHints *wmhints = nullptr;
+    XSizeHints *sizehints = nullptr;
+    char title[] = "game";
+    int mouse_x = 0;
+    int mouse_y = 0;
+    bool mouse_btn_down[5] = {};
+    const int btn_remap[5] = {0, 0, 2, 1, 3};
+
+    // Presentation
+    XImage *image = nullptr;
+    XShmSegmentInfo shm_segment = {};
+    bool is_shm_used = false;
+    int shm_completion_event = -1;
+    bool is_present_pending = false;
+    bool is_full_present_needed = true;
+    bool is_attach_failed = false;
+
+    void term_sig_handler(int)
+    {
+        quit = true;
+    }
+
+    uint64_t get_nsec()
+    {
+        timespec ts = { 0, 0 };
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000 + uint64_t(ts.tv_nsec);
+    }
+
+    //----------------------------------------------------------------
+    // Input
+    //----------------------------------------------------------------
+
+    void on_key_event(XKeyEvent &key_event, bool pressed)
+    {
+        const int buf_size = 256;
+        char buf[buf_size];
+        KeySym ks;
+        XLookupString(&key_event, buf, buf_size, &ks, NULL);
+
+        switch (ks)
+        {
+            case XK_Left:
+                keys[VK_LEFT] = pressed;
+                break;
+            case XK_Right:
+                keys[VK_RIGHT] = pressed;
+                break;
+            case XK_Down:
+                keys[VK_DOWN] = pressed;
+                break;
+            case XK_Up:
+                keys[VK_UP] = pressed;
+                break;
+            case XK_Escape:
+                keys[VK_ESCAPE] = pressed;
+                break;
+            case XK_space:
+                keys[VK_SPACE] = pressed;
+                break;
+            case XK_Return:
+                keys[VK_RETURN] = pressed;
+                break;
+        }
+    }
+
+    void process_event(XEvent &event)
+    {
+        if (event.type == shm_completion_event)
+        {
+            is_present_pending = false;
+            return;
+        }
+
+        if (event.type == Expose)
+            is_full_present_needed = true;
+
+        if (event.type == KeyPress)
+            on_key_event(event.xkey, true);
+
+        if (event.type == KeyRelease)
+            on_key_event(event.xkey, false);
+
+        if (event.type == ButtonPress && event.xbutton.button > 0 && event.xbutton.button <= 5)
+            mouse_btn_down[btn_remap[event.xbutton.button]] = true;
+
+        if (event.type == ButtonRelease && event.xbutton.button > 0 && event.xbutton.button <= 5)
+            mouse_btn_down[btn_remap[event.xbutton.button]] = false;
+
+        if (event.type == ClientMessage && event.xclient.data.l[0] == (long)wm_delete_message)
+            quit = true;
+
+        Window root_return, child_return;
+        int root_x_return, root_y_return;
+        int win_x_return, win_y_return;
+        unsigned int mask_return;
+        if (XQueryPointer(display, window, &root_return, &child_return, &root_x_return, &root_y_return,
+                          &win_x_return, &win_y_return, &mask_return))
+        {
+            mouse_x = win_x_return;
+            mouse_y = win_y_return;
+        }
+    }
+
+    //----------------------------------------------------------------
+    // Shared buffer
+    //----------------------------------------------------------------
+
+    int trap_attach_error(Display *, XErrorEvent *)
+    {
+        is_attach_failed = true;
+        return 0;
+    }
+
+    // Puts ordinary private memory back under buffer, the game may still draw to it
+    void detach_shared_buffer()
+    {
+        shmdt(shm_segment.shmaddr);
+        mmap(buffer, sizeof(buffer), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        shm_segment = {};
+    }
+
+    bool attach_shared_buffer()
+    {
+        if (!XShmQueryExtension(display) || reinterpret_cast<uintptr_t>(buffer) % SHMLBA != 0)
+            return false;
+
+        shm_segment.shmid = shmget(IPC_PRIVATE, sizeof(buffer), IPC_CREAT | 0600);
+        if (shm_segment.shmid < 0)
+            return false;
+
+        // The segment replaces the pages of buffer, the game keeps drawing to the same address
+        void *address = shmat(shm_segment.shmid, buffer, SHM_REMAP);
+        if (address == reinterpret_cast<void *>(-1))
+        {
+            shmctl(shm_segment.shmid, IPC_RMID, nullptr);
+            return false;
+        }
+        shm_segment.shmaddr = static_cast<char *>(address);
+        shm_segment.readOnly = True;
+
+        image = XShmCreateImage(display, visual, 24, ZPixmap, shm_segment.shmaddr, &shm_segment, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (image && image->bytes_per_line == SCREEN_WIDTH * sizeof(uint32_t))
+        {
+            // A remote server can't attach the segment, the error comes back asynchronously
+            is_attach_failed = false;
+            XErrorHandler prev_handler = XSetErrorHandler(trap_attach_error);
+            XShmAttach(display, &shm_segment);
+            XSync(display, False);
+            XSetErrorHandler(prev_handler);
+        }
+        else
+        {
+            is_attach_failed = true;
+        }
+
+        // Both sides are attached (or failed to), the segment is freed when the last one detaches
+        shmctl(shm_segment.shmid, IPC_RMID, nullptr);
+
+        if (is_attach_failed)
+        {
+            if (image)
+                XDestroyImage(image);
+            image = nullptr;
+            detach_shared_buffer();
+            return false;
+        }
+
+        shm_completion_event = XShmGetEventBase(display) + ShmCompletion;
+        return true;
+    }
+
+    //----------------------------------------------------------------
+    // Presentation
+    //----------------------------------------------------------------
+
+    // The server may be reading buffer till the completion event, draw() must not touch it before
+    void wait_for_present()
+    {
+        XEvent event;
+        while (is_present_pending)
+        {
+            XNextEvent(display, &event);
+            process_event(event);
+        }
+    }
+
+    void present_frame()
+    {
+        static const std::vector<ScreenRect> Full_screen = { ScreenRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT) };
+        const std::vector<ScreenRect> &rects = is_full_present_needed ? Full_screen : get_frame_damage();
+        is_full_present_needed = false;
+
+        // Only the last put asks for the completion event, puts are done in order
+        size_t last_rect_id = rects.size();
+        for (size_t rect_id = 0; rect_id < rects.size(); ++rect_id)
+        {
+            if (!rects[rect_id].is_empty())
+                last_rect_id = rect_id;
+        }
+
+        for (size_t rect_id = 0; rect_id < rects.size(); ++rect_id)
+        {
+            const ScreenRect &rect = rects[rect_id];
+            if (rect.is_empty())
+                continue;
+
+            if (is_shm_used)
+            {
+                XShmPutImage(display, window, gc, image, rect.left, rect.top, rect.left, rect.top,
+                             rect.get_width(), rect.get_height(), rect_id == last_rect_id);
+            }
+            else
+            {
+                XPutImage(display, window, gc, image, rect.left, rect.top, rect.left, rect.top,
+                          rect.get_width(), rect.get_height());
+            }
+        }
+
+        is_present_pending = is_shm_used && last_rect_id < rects.size();
+        XFlush(display);
+    }
+}
+
+//----------------------------------------------------------------
+// Engine.h for the game
+//----------------------------------------------------------------
+
+bool is_key_pressed(int button_vk_code)
+{
+    if (unsigned(button_vk_code) >= VK__COUNT)
+        return false;
+    return keys[button_vk_code];
+}
+
+bool is_mouse_button_pressed(int mouse_button)
+{
+    return mouse_btn_down[mouse_button];
+}
+
+int get_cursor_x()
+{
+    return mouse_x;
+}
+
+int get_cursor_y()
+{
+    return mouse_y;
+}
+
+void schedule_quit_game()
+{
+    quit = true;
+}
+
+//----------------------------------------------------------------
+
+int main(int, const char **)
+{
+    if ((display = XOpenDisplay(getenv("DISPLAY"))) == NULL)
+    {
+        fprintf(stderr, "Cannot connect X server: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    screen = XDefaultScreen(display);
+    visual = DefaultVisual(display, screen);
+    gc = DefaultGC(display, screen);
+    window = XCreateWindow(display, DefaultRootWindow(display),
+        10, 10, SCREEN_WIDTH, SCREEN_HEIGHT, 1, 24, InputOutput, CopyFromParent, 0, 0);
+
+    classhint = XAllocClassHint();
+    classhint->res_name = title;
+    classhint->res_class = title;
+
+    wmhints = XAllocWMHints();
+    wmhints->input = true;
+    wmhints->flags = InputHint;
+
+    sizehints = XAllocSizeHints();
+    sizehints->flags = PMaxSize | PMinSize;
+    sizehints->min_width = sizehints->max_width = SCREEN_WIDTH;
+    sizehints->min_height = sizehints->max_height = SCREEN_HEIGHT;
+    XSetWMProperties(display, window, NULL, NULL, NULL, 0, sizehints, wmhints, classhint);
+
+    XSelectInput(display, window, ExposureMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask);
+    XMapWindow(display, window);
+    wm_delete_message = XInternAtom(display, "WM_DELETE_WINDOW", false);
+    XSetWMProtocols(display, window, &wm_delete_message, 1);
+
+    // Before initialize(): attaching replaces the content of buffer
+    const char *no_shm = getenv("LANDER_NO_SHM");
+    is_shm_used = !(no_shm && strcmp(no_shm, "0") != 0) && attach_shared_buffer();
+    if (!is_shm_used)
+        image = XCreateImage(display, visual, 24, ZPixmap, 0, (char *)buffer, SCREEN_WIDTH, SCREEN_HEIGHT, 32, 0);
+
+    fprintf(stderr, "Presenting frames with %s\n", is_shm_used ? "MIT-SHM" : "XPutImage");
+
+    XFlush(display);
+
+    initialize();
+
+    uint64_t prev_time = get_nsec();
+
+    signal(SIGINT, term_sig_handler);
+    signal(SIGTERM, term_sig_handler);
+
+    XEvent event;
+    for (;;)
+    {
+        sched_yield();
+
+        while (XPending(display))
+        {
+            XNextEvent(display, &event);
+            process_event(event);
+        }
+
+        uint64_t cur_time = get_nsec();
+        if (cur_time == prev_time)
+            continue;
+
+        float dt = float(double(cur_time - prev_time) * 1e-9);
+        if (dt > 0.1f)
+            dt = 0.1f;
+        act(dt);
+        prev_time = cur_time;
+
+        if (quit)
+            break;
+
+        wait_for_present();
+        draw();
+        present_frame();
+    }
+
+    wait_for_present();
+    finalize();
+
+    if (is_shm_used)
+    {
+        XShmDetach(display, &shm_segment);
+        XSync(display, False);
+        XDestroyImage(image);
+        detach_shared_buffer();
+    }
+    else
+    {
+        // buffer is not ours to free
+        image->data = nullptr;
+        XDestroyImage(image);
+    }
+
+    XFree(classhint);
+    XFree(wmhints);
+    XFree(sizehints);
+    XCloseDisplay(display);
+
+    return 0;
+}
@@ -0,0 +1,366 @@
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "Engine.h"
+#include "Game.h"
+#include "TripleBuffer.h"
+
+/*
+*   Engine.cpp with the frames shown by a separate thread. In Engine.cpp the
+*   game waits for XPutImage, XCopyArea and XFlush after every draw(). Here
+*   draw() renders into one of three frames of a swap chain and publishes it,
+*   and the present thread, which owns the X connection, takes the latest
+*   published frame and shows it. The handoff is an atomic exchange of frame
+*   indices (TripleBuffer), so neither side ever waits for the other: the game
+*   keeps drawing while the X server is busy and frames that were not shown
+*   in time are skipped.
+*
+*   The present thread also reads the X events and keeps the input state for
+*   the game, the main thread never calls Xlib after the window is created.
+*/
+
+// Not shown, the game draws to the frames of the swap chain
+uint32_t buffer[SCREEN_HEIGHT][SCREEN_WIDTH] = {};
+
+namespace
+{
+    struct Frame
+    {
+        std::vector<uint32_t> pixels = std::vector<uint32_t>(SCREEN_WIDTH * SCREEN_HEIGHT);
+
+        // Areas changed since the previous frame
+        std::vector<ScreenRect> damage;
+        uint64_t id = 0;
+    };
+
+    TripleBuffer<Frame> swap_chain;
+
+    // Written by the main thread after every publish, wakes the present thread
+    int frame_ready_fd = -1;
+
+    std::atomic<bool> keys[VK__COUNT] = {};
+    std::atomic<bool> mouse_btn_down[5] = {};
+    std::atomic<int> mouse_x = 0;
+    std::atomic<int> mouse_y = 0;
+    std::atomic<bool> quit = false;
+
+    // Present thread only
+    Display *display = nullptr;
+    Window window;
+    Visual *visual = nullptr;
+    GC gc = 0;
+    Pixmap pixmap = 0;
+    XImage *image = nullptr;
+    int screen = 0;
+    Atom wm_delete_message = 0;
+    XClassHint *classhint = nullptr;
+    XWMHints *wmhints = nullptr;
+    XSizeHints *sizehints = nullptr;
+    char title[] = "game";
+    const int btn_remap[5] = {0, 0, 2, 1, 3};
+
+    uint64_t last_presented_id = 0;
+    bool is_expose_pending = false;
+
+    void term_sig_handler(int)
+    {
+        quit = true;
+    }
+
+    uint64_t get_nsec()
+    {
+        timespec ts = { 0, 0 };
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000 + uint64_t(ts.tv_nsec);
+    }
+
+    //----------------------------------------------------------------
+    // Present thread
+    //----------------------------------------------------------------
+
+    void on_key_event(XKeyEvent &key_event, bool pressed)
+    {
+        const int buf_size = 256;
+        char buf[buf_size];
+        KeySym ks;
+        XLookupString(&key_event, buf, buf_size, &ks, NULL);
+
+        switch (ks)
+        {
+            case XK_Left:
+                keys[VK_LEFT] = pressed;
+                break;
+            case XK_Right:
+                keys[VK_RIGHT] = pressed;
+                break;
+            case XK_Down:
+                keys[VK_DOWN] = pressed;
+                break;
+            case XK_Up:
+                keys[VK_UP] = pressed;
+                break;
+            case XK_Escape:
+                keys[VK_ESCAPE] = pressed;
+                break;
+            case XK_space:
+                keys[VK_SPACE] = pressed;
+                break;
+            case XK_Return:
+                keys[VK_RETURN] = pressed;
+                break;
+        }
+    }
+
+    void process_event(XEvent &event)
+    {
+        if (event.type == Expose)
+            is_expose_pending = true;
+
+        if (event.type == KeyPress)
+            on_key_event(event.xkey, true);
+
+        if (event.type == KeyRelease)
+            on_key_event(event.xkey, false);
+
+        if (event.type == ButtonPress && event.xbutton.button > 0 && event.xbutton.button <= 5)
+            mouse_btn_down[btn_remap[event.xbutton.button]] = true;
+
+        if (event.type == ButtonRelease && event.xbutton.button > 0 && event.xbutton.button <= 5)
+            mouse_btn_down[btn_remap[event.xbutton.button]] = false;
+
+        if (event.type == ClientMessage && event.xclient.data.l[0] == (long)wm_delete_message)
+            quit = true;
+
+        Window root_return, child_return;
+        int root_x_return, root_y_return;
+        int win_x_return, win_y_return;
+        unsigned int mask_return;
+        if (XQueryPointer(display, window, &root_return, &child_return, &root_x_return, &root_y_return,
+                          &win_x_return, &win_y_return, &mask_return))
+        {
+            mouse_x = win_x_return;
+            mouse_y = win_y_return;
+        }
+    }
+
+    // The pixmap keeps the last shown frame for expose events
+    void present_frame(const Frame &frame)
+    {
+        static const std::vector<ScreenRect> Full_screen = { ScreenRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT) };
+
+        // Skipped frames changed more than the damage of this one
+        bool is_next_frame = last_presented_id != 0 && frame.id == last_presented_id + 1;
+        const std::vector<ScreenRect> &rects = is_next_frame ? frame.damage : Full_screen;
+        last_presented_id = frame.id;
+
+        image->data = reinterpret_cast<char *>(const_cast<uint32_t *>(frame.pixels.data()));
+        for (const ScreenRect &rect : rects)
+        {
+            if (rect.is_empty())
+                continue;
+
+            XPutImage(display, pixmap, gc, image, rect.left, rect.top, rect.left, rect.top,
+                      rect.get_width(), rect.get_height());
+            XCopyArea(display, pixmap, window, gc, rect.left, rect.top,
+                      rect.get_width(), rect.get_height(), rect.left, rect.top);
+        }
+    }
+
+    void present_loop()
+    {
+        pollfd fds[2] = {
+            { ConnectionNumber(display), POLLIN, 0 },
+            { frame_ready_fd           , POLLIN, 0 },
+        };
+
+        XEvent event;
+        while (!quit)
+        {
+            while (XPending(display))
+            {
+                XNextEvent(display, &event);
+                process_event(event);
+            }
+
+            if (swap_chain.update())
+                present_frame(swap_chain.get_read_buffer());
+
+            if (is_expose_pending)
+            {
+                XCopyArea(display, pixmap, window, gc, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0);
+                is_expose_pending = false;
+            }
+
+            XFlush(display);
+
+            // Sleep till an X event or a new frame, the timeout only rechecks quit
+            static constexpr int Poll_timeout_ms = 100;
+            if (poll(fds, 2, Poll_timeout_ms) > 0 && (fds[1].revents & POLLIN))
+            {
+                uint64_t frames_count = 0;
+                if (read(frame_ready_fd, &frames_count, sizeof(frames_count)) < 0)
+                    continue;
+            }
+        }
+    }
+
+    void notify_frame_ready()
+    {
+        uint64_t one = 1;
+        if (write(frame_ready_fd, &one, sizeof(one)) < 0)
+            return;
+    }
+}
+
+//----------------------------------------------------------------
+// Engine.h for the game
+//----------------------------------------------------------------
+
+bool is_key_pressed(int button_vk_code)
+{
+    if (unsigned(button_vk_code) >= VK__COUNT)
+        return false;
+    return keys[button_vk_code];
+}
+
+bool is_mouse_button_pressed(int mouse_button)
+{
+    return mouse_btn_down[mouse_button];
+}
+
+int get_cursor_x()
+{
+    return mouse_x;
+}
+
+int get_cursor_y()
+{
+    return mouse_y;
+}
+
+void schedule_quit_game()
+{
+    quit = true;
+}
+
+//----------------------------------------------------------------
+
+int main(int, const char **)
+{
+    if ((display = XOpenDisplay(getenv("DISPLAY"))) == NULL)
+    {
+        fprintf(stderr, "Cannot connect X server: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    // Non blocking: the main thread must not wait even if the present thread is stuck
+    if ((frame_ready_fd = eventfd(0, EFD_NONBLOCK)) < 0)
+    {
+        fprintf(stderr, "Cannot create eventfd: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    screen = XDefaultScreen(display);
+    visual = DefaultVisual(display, screen);
+    gc = DefaultGC(display, screen);
+    window = XCreateWindow(display, DefaultRootWindow(display),
+        10, 10, SCREEN_WIDTH, SCREEN_HEIGHT, 1, 24, InputOutput, CopyFromParent, 0, 0);
+
+    classhint = XAllocClassHint();
+    classhint->res_name = title;
+    classhint->res_class = title;
+
+    wmhints = XAllocWMHints();
+    wmhints->input = true;
+    wmhints->flags = InputHint;
+
+    sizehints = XAllocSizeHints();
+    sizehints->flags = PMaxSize | PMinSize;
+    sizehints->min_width = sizehints->max_width = SCREEN_WIDTH;
+    sizehints->min_height = sizehints->max_height = SCREEN_HEIGHT;
+    XSetWMProperties(display, window, NULL, NULL, NULL, 0, sizehints, wmhints, classhint);
+
+    pixmap = XCreatePixmap(display, window, SCREEN_WIDTH, SCREEN_HEIGHT, 24);
+
+    XSelectInput(display, window, ExposureMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask);
+    XMapWindow(display, window);
+    wm_delete_message = XInternAtom(display, "WM_DELETE_WINDOW", false);
+    XSetWMProtocols(display, window, &wm_delete_message, 1);
+
+    // Data points to the frame being presented
+    image = XCreateImage(display, visual, 24, ZPixmap, 0, nullptr, SCREEN_WIDTH, SCREEN_HEIGHT, 32, 0);
+
+    XFlush(display);
+
+    initialize();
+
+    signal(SIGINT, term_sig_handler);
+    signal(SIGTERM, term_sig_handler);
+
+    // From here on the X connection belongs to the present thread
+    std::thread present_thread(present_loop);
+
+    uint64_t prev_time = get_nsec();
+    uint64_t frames_count = 0;
+    for (;;)
+    {
+        sched_yield();
+
+        uint64_t cur_time = get_nsec();
+        if (cur_time == prev_time)
+            continue;
+
+        float dt = float(double(cur_time - prev_time) * 1e-9);
+        if (dt > 0.1f)
+            dt = 0.1f;
+        act(dt);
+        prev_time = cur_time;
+
+        if (quit)
+            break;
+
+        Frame &frame = swap_chain.get_write_buffer();
+        set_render_target(frame.pixels.data());
+        draw();
+
+        frame.damage = get_frame_damage();
+        frame.id = ++frames_count;
+        swap_chain.publish();
+        notify_frame_ready();
+    }
+
+    quit = true;
+    notify_frame_ready();
+    present_thread.join();
+
+    finalize();
+
+    // The frames are not ours to free
+    image->data = nullptr;
+    XDestroyImage(image);
+
+    close(frame_ready_fd);
+    XFree(classhint);
+    XFree(wmhints);
+    XFree(sizehints);
+    XFreePixmap(display, pixmap);
+    XCloseDisplay(display);
+
+    return 0;
+}
@@ -1,11 +1,19 @@
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
 #include <memory.h>
 
 #include "Engine.h"
+#include "Game.h"
+#include "InputRecording.h"
 #include "Planet.h"
 #include "ProgressBar.h"
+#include "RenderQueue.h"
 #include "Rocket.h"
+#include "Simulation.h"
+#include "SleepIslands.h"
+#include "TileRenderer.h"
+#include "TrajectoryPredictor.h"
 
 /* 
 *  This is an anonymous namespace for game data
@@ -15,8 +23,10 @@
 */
 namespace
 {
-    Rocket rocket(Vector2d(50, 80), true);
-    Planet planet(SCREEN_WIDTH, SCREEN_HEIGHT);
+    // Rocket, planet and collision handling, the rest of the file is about the player
+    Simulation simulation(SCREEN_WIDTH, SCREEN_HEIGHT);
+    Rocket &rocket = simulation.get_rocket();
+    Planet &planet = simulation.get_planet();
 
     //----------------------------------------------------------------
     // Fuel bars
@@ -50,16 +60,83 @@ namespace
     bool player_wins = false;
     bool player_lose = false;
 
-    bool pause = false;
+    bool is_paused = false;
+
+    //----------------------------------------------------------------
+    // Sleeping of settled bodies
+    //----------------------------------------------------------------
+    SleepIslands islands;
+    const size_t rocket_body_id = islands.add_body();
+
+    //----------------------------------------------------------------
+    // Partial redraw
+    //----------------------------------------------------------------
+    DamageTracker damage(SCREEN_WIDTH, SCREEN_HEIGHT);
+    const size_t rocket_damage_id        = damage.add_object();
+    const size_t fuel_bar_damage_id      = damage.add_object();
+    const size_t hydrazine_bar_damage_id = damage.add_object();
+    const size_t win_screen_damage_id    = damage.add_object();
+    const size_t lose_screen_damage_id   = damage.add_object();
+    const size_t prediction_damage_id    = damage.add_object();
+
+    //----------------------------------------------------------------
+    // Rendering: damaged areas are drawn in tiles on all cores
+    //----------------------------------------------------------------
+    RenderQueue render_queue(SCREEN_WIDTH, SCREEN_HEIGHT);
+    TileRenderer renderer(SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    constexpr int Background_z = 0;
+    constexpr int Objects_z    = 1;
+    constexpr int Overlay_z    = 2;
+    constexpr int Interface_z  = 3;
+
+    //----------------------------------------------------------------
+    // Render targets, a target that missed some frames gets their damage repainted
+    //----------------------------------------------------------------
+    struct RenderTarget
+    {
+        uint32_t *pixels = nullptr;
+        std::vector<ScreenRect> missed_damage;
+    };
+
+    std::vector<RenderTarget> render_targets = { RenderTarget{ reinterpret_cast<uint32_t *>(buffer), {} } };
+    size_t render_target_id = 0;
+
+    // More missed rects are united into one, there is no point to repaint them one by one
+    constexpr size_t Max_missed_rects = 32;
+
+    //----------------------------------------------------------------
+    // Predicted trajectory overlay
+    //----------------------------------------------------------------
+    TrajectoryPredictor predictor(SCREEN_WIDTH, SCREEN_HEIGHT);
+    bool is_prediction_enabled = true;
+
+    // Predictions made before the restart belong to the old planet
+    uint64_t first_episode_request_id = 1;
+
+    constexpr int Trajectory_dot_size   = 2;
+    constexpr int Impact_marker_size    = 8;
+    constexpr int Alt_impact_marker_size = 4;
+
+    //----------------------------------------------------------------
+    // Session recording, enabled by the LANDER_RECORD environment variable
+    //----------------------------------------------------------------
+    InputRecorder recorder;
+    bool is_recording_enabled = true;
+    bool has_session_seed = false;
+    uint32_t session_seed = 0;
 };
 
 static void handle_input();
 static void key_press_callback(int vk_key_code);
 static void key_release_callback(int vk_key_code);
-static void handle_collisions(float dt);
 static void show_fps(float dt);
-static void update_all(float dt);
+static void update_bars();
 static void restart();
+static void add_missed_damage(const std::vector<ScreenRect> &frame_damage);
+static bool is_prediction_shown();
+static ScreenRect get_prediction_bounds();
+static void submit_prediction(RenderQueue &queue);
 
 //----------------------------------------------------------------
 // Four main functions to engine call
@@ -67,7 +144,15 @@ static void restart();
 
 void initialize()
 {
-    std::srand(time(NULL));
+    uint32_t seed = has_session_seed ? session_seed : static_cast<uint32_t>(time(NULL));
+    std::srand(seed);
+
+    const char *record_path = std::getenv("LANDER_RECORD");
+    if (is_recording_enabled && record_path)
+    {
+        if (!recorder.begin(record_path, seed))
+            std::cerr << "Can't record the session to " << record_path << '\n';
+    }
 
     // setup rocket
     //----------------------------------------------------------------
@@ -112,8 +197,9 @@ void initialize()
 void act(float dt)
 {
     handle_input();
+    recorder.record_frame(dt);
 
-    if (pause)
+    if (is_paused)
         return;
 
     if (player_lose || player_wins)
@@ -128,8 +214,20 @@ void act(float dt)
         return;
     }
 
-    update_all(dt);
-    handle_collisions(dt);
+    // A settled rocket is neither integrated nor checked for collisions until input wakes it
+    islands.begin_frame();
+    if (!islands.is_sleeping(rocket_body_id))
+    {
+        simulation.step(dt);
+        update_bars();
+
+        // The answer comes in one of the next frames, act never waits for it
+        if (is_prediction_enabled && rocket.get_state() == Rocket::RocketState::IN_FLIGHT)
+            predictor.request(rocket.get_snapshot(), simulation.get_seed());
+
+        islands.report_motion(rocket_body_id, rocket.get_velocity(), rocket.get_rotation_speed(), rocket.has_contacts());
+    }
+    islands.end_frame();
 
     switch (rocket.get_state())
     {
@@ -152,27 +250,97 @@ void act(float dt)
     show_fps(dt);
 }
 
+/*
+*   Only the damaged parts of the buffer are cleared and repainted,
+*   the rest still holds the previous frame. Objects submit their
+*   commands to the render queue, the renderer runs it.
+*/
 void draw()
 {
-    auto buffer_as_1D = reinterpret_cast<uint32_t *>(buffer);
-    memset(buffer, 0, SCREEN_HEIGHT * SCREEN_WIDTH * sizeof(uint32_t));
+    bool prediction_changed = is_prediction_enabled && predictor.update();
+    bool show_prediction = is_prediction_shown();
+
+    damage.report(rocket_damage_id       , rocket.get_screen_bounds(), !islands.is_sleeping(rocket_body_id));
+    damage.report(fuel_bar_damage_id     , fuel_bar.get_screen_bounds());
+    damage.report(hydrazine_bar_damage_id, hydrazine_bar.get_screen_bounds());
+    damage.report(win_screen_damage_id   , player_wins ? win_screen .get_screen_bounds() : ScreenRect(), false);
+    damage.report(lose_screen_damage_id  , player_lose ? lose_screen.get_screen_bounds() : ScreenRect(), false);
+    damage.report(prediction_damage_id   , show_prediction ? get_prediction_bounds() : ScreenRect(), prediction_changed);
 
-    planet.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
-    rocket.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
+    render_queue.clear();
 
-    fuel_bar.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
-    hydrazine_bar.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
+    // Planet's background layer is opaque and overwrites the previous frame
+    planet.submit(render_queue, Background_z);
+    rocket.submit(render_queue, Objects_z);
+
+    if (show_prediction)
+        submit_prediction(render_queue);
+
+    fuel_bar.submit(render_queue, Interface_z);
+    hydrazine_bar.submit(render_queue, Interface_z);
 
     if (player_lose)
-        lose_screen.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
+        lose_screen.submit(render_queue, Interface_z);
     if (player_wins)
-        win_screen.draw(buffer_as_1D, SCREEN_WIDTH, SCREEN_HEIGHT);
+        win_screen.submit(render_queue, Interface_z);
+
+    RenderTarget &target = render_targets[render_target_id];
+    for (const ScreenRect &rect : target.missed_damage)
+        damage.add_damage(rect);
+    target.missed_damage.clear();
+
+    const std::vector<ScreenRect> &frame_damage = damage.finish_frame();
+    render_queue.prepare(frame_damage);
+    renderer.render(render_queue, target.pixels, frame_damage);
+
+    add_missed_damage(frame_damage);
+}
+
+const std::vector<ScreenRect> &get_frame_damage()
+{
+    return damage.get_frame_damage();
 }
 
 /*
-*   Nothing to free because of destructors
+*   Nothing else to free because of destructors
 */
-void finalize() {}
+void finalize()
+{
+    recorder.end();
+}
+
+void set_session_seed(uint32_t seed)
+{
+    has_session_seed = true;
+    session_seed = seed;
+}
+
+void set_prediction_enabled(bool is_enabled)
+{
+    is_prediction_enabled = is_enabled;
+}
+
+void set_recording_enabled(bool is_enabled)
+{
+    is_recording_enabled = is_enabled;
+}
+
+void set_render_target(uint32_t *pixels)
+{
+    auto target = std::find_if(render_targets.begin(), render_targets.end(), [pixels](const RenderTarget &target)
+    {
+        return target.pixels == pixels;
+    });
+
+    // Nothing is known about the content of a new target
+    if (target == render_targets.end())
+    {
+        ScreenRect screen(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        target = render_targets.insert(render_targets.end(), RenderTarget{ pixels, { screen } });
+    }
+
+    render_target_id = target - render_targets.begin();
+}
 
 //-----------------------------------------------------------------
 //  There are some stuff functions for game
@@ -209,6 +377,9 @@ static void handle_input()
 
 static void key_press_callback(int vk_key_code)
 {
+    islands.wake(rocket_body_id);
+    recorder.add_event(vk_key_code, true);
+
     switch (vk_key_code)
     {
         case VK_ESCAPE:
@@ -244,7 +415,7 @@ static void key_press_callback(int vk_key_code)
         }
         case VK_SPACE:
         {
-            pause = !pause;
+            is_paused = !is_paused;
             break;
         }
         default:
@@ -256,6 +427,9 @@ static void key_press_callback(int vk_key_code)
 
 static void key_release_callback(int vk_key_code)
 {
+    islands.wake(rocket_body_id);
+    recorder.add_event(vk_key_code, false);
+
     switch (vk_key_code)
     {
         case VK_LEFT:
@@ -277,25 +451,6 @@ static void key_release_callback(int vk_key_code)
     }
 }
 
-static void handle_collisions(float dt)
-{
-    static std::vector<CollisionInfo> info;
-    static constexpr size_t Probable_max_number_of_mtvs = 8;
-    info.reserve(Probable_max_number_of_mtvs);
-
-    const auto &colliders = rocket.get_colliders();
-    size_t number_of_colliders = colliders.size();
-    for (size_t i = 0; i < number_of_colliders; ++i)
-    {
-        bool mtv_if_collision = planet.check_collision(colliders[i], info, dt);
-        if (mtv_if_collision)
-        {
-            for (const auto &collision_info : info)
-                rocket.apply_collision_response(i, collision_info, dt, info.size());
-        }
-    }
-}
-
 static void show_fps(float dt)
 {
     static const size_t frames_to_show_fps = 100;
@@ -312,19 +467,114 @@ static void show_fps(float dt)
     }
 }
 
-static void update_all(float dt)
+static void update_bars()
 {
-    rocket.update(dt);
-
     fuel_bar.set_progress(rocket.get_fuel());
     hydrazine_bar.set_progress(rocket.get_hydrazine());
 }
 
 static void restart()
 {
-    planet.generate_stars();
-    planet.generate_landscape(SCREEN_WIDTH >> 5, SCREEN_HEIGHT / 4, 150);
+    damage.invalidate();
+    islands.wake(rocket_body_id);
+
+    simulation.restart(std::rand());
+    first_episode_request_id = predictor.get_last_request_id() + 1;
+}
+
+// Other targets still hold older frames, they have to repaint what this frame changed
+static void add_missed_damage(const std::vector<ScreenRect> &frame_damage)
+{
+    for (size_t target_id = 0; target_id < render_targets.size(); ++target_id)
+    {
+        if (target_id == render_target_id)
+            continue;
+
+        std::vector<ScreenRect> &missed_damage = render_targets[target_id].missed_damage;
+        missed_damage.insert(missed_damage.end(), frame_damage.begin(), frame_damage.end());
+
+        if (missed_damage.size() > Max_missed_rects)
+        {
+            ScreenRect united = missed_damage.front();
+            for (const ScreenRect &rect : missed_damage)
+                united = united.unite(rect);
+            missed_damage.assign(1, united);
+        }
+    }
+}
+
+//-----------------------------------------------------------------
+//  Prediction overlay: the path with the current controls and the
+//  touchdown points of the other controls, green where they land
+//-----------------------------------------------------------------
+
+static bool is_prediction_shown()
+{
+    return is_prediction_enabled && !player_wins && !player_lose &&
+           predictor.get_prediction().request_id >= first_episode_request_id;
+}
+
+static Color get_verdict_color(TrajectoryPredictor::Verdict verdict)
+{
+    switch (verdict)
+    {
+        case TrajectoryPredictor::Verdict::LANDS:
+        {
+            return Color::Green;
+        }
+        case TrajectoryPredictor::Verdict::CRASHES:
+        {
+            return Color::Red;
+        }
+        default:
+        {
+            return Color::Yellow;
+        }
+    }
+}
+
+static ScreenRect get_marker_rect(Vector2d position, int size)
+{
+    int left = static_cast<int>(position.x) - size / 2;
+    int top  = static_cast<int>(position.y) - size / 2;
+    return ScreenRect(left, top, left + size, top + size);
+}
+
+template<typename MarkerCallback>
+static void for_each_prediction_marker(MarkerCallback callback)
+{
+    const auto &rollouts = predictor.get_prediction().rollouts;
+    for (size_t i = 0; i < rollouts.size(); ++i)
+    {
+        const TrajectoryPredictor::Rollout &rollout = rollouts[i];
+        Color color = get_verdict_color(rollout.verdict);
+
+        if (i == 0)
+        {
+            for (Vector2d point : rollout.trajectory)
+                callback(get_marker_rect(point, Trajectory_dot_size), color);
+        }
+
+        if (rollout.verdict != TrajectoryPredictor::Verdict::STILL_FLYING)
+            callback(get_marker_rect(rollout.impact_point, i == 0 ? Impact_marker_size : Alt_impact_marker_size), color);
+    }
+}
 
-    rocket.set_default_configuration();
-    rocket.set_position(SCREEN_WIDTH / 10, SCREEN_HEIGHT / 10);
+static ScreenRect get_prediction_bounds()
+{
+    ScreenRect bounds;
+    for_each_prediction_marker([&bounds](const ScreenRect &marker, Color)
+    {
+        bounds = bounds.unite(marker);
+    });
+
+    return bounds;
+}
+
+static void submit_prediction(RenderQueue &queue)
+{
+    for_each_prediction_marker([&queue](const ScreenRect &marker, Color color)
+    {
+        queue.add_fill(marker, color, Overlay_z);
+    });
 }
\ No newline at end of file
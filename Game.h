@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DamageTracker.h"
+
+/*
+*   Game specific additions to the interface of Engine.h
+*/
+
+// Screen areas repainted by the last draw() call, the rest of the buffer is unchanged
+const std::vector<ScreenRect> &get_frame_damage();
+
+// Seeds the session with the seed instead of the current time, call before initialize()
+void set_session_seed(uint32_t seed);
+
+// Overlay of the predicted trajectory, drawn frames depend on the timing of its threads
+void set_prediction_enabled(bool is_enabled);
+
+// Recording of the session to LANDER_RECORD, off for replays so a record is never overwritten. Call before initialize()
+void set_recording_enabled(bool is_enabled);
+
+// Pixels of the screen size draw() renders into, the buffer from Engine.h by default. Every
+// target remembers the frames drawn to the others and repaints their damage when it is used again.
+void set_render_target(uint32_t *pixels);
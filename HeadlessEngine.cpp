@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "Engine.h"
+#include "HeadlessEngine.h"
+
+uint32_t buffer[SCREEN_HEIGHT][SCREEN_WIDTH] = {};
+
+namespace
+{
+    bool keys_pressed[VK__COUNT] = {};
+    bool quit = false;
+}
+
+void set_key_pressed(int button_vk_code, bool is_pressed)
+{
+    if (button_vk_code >= 0 && button_vk_code < VK__COUNT)
+        keys_pressed[button_vk_code] = is_pressed;
+}
+
+bool is_quit_scheduled()
+{
+    return quit;
+}
+
+uint64_t hash_frame()
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t y = 0; y < SCREEN_HEIGHT; ++y)
+    {
+        for (size_t x = 0; x < SCREEN_WIDTH; ++x)
+        {
+            hash ^= buffer[y][x];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+//----------------------------------------------------------------
+// Engine.h for the game
+//----------------------------------------------------------------
+
+bool is_key_pressed(int button_vk_code)
+{
+    return button_vk_code >= 0 && button_vk_code < VK__COUNT && keys_pressed[button_vk_code];
+}
+
+bool is_mouse_button_pressed(int)
+{
+    return false;
+}
+
+int get_cursor_x()
+{
+    return 0;
+}
+
+int get_cursor_y()
+{
+    return 0;
+}
+
+void schedule_quit_game()
+{
+    quit = true;
+}
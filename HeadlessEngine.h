@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+*   Engine.h without a display, shared by game_headless and replay_runner.
+*   buffer is ordinary memory, the keys are pressed by the runner, the mouse
+*   is never used and schedule_quit_game() only raises a flag for the runner
+*   to check after act().
+*/
+
+// Keys outside of VK__COUNT are ignored
+void set_key_pressed(int button_vk_code, bool is_pressed);
+
+// Set by schedule_quit_game()
+bool is_quit_scheduled();
+
+// FNV-1a of buffer, equal frames give equal hashes on any machine
+uint64_t hash_frame();
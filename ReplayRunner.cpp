@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Engine.h"
+#include "Game.h"
+#include "HeadlessEngine.h"
+#include "InputRecording.h"
+
+/*
+*   Plays a session recorded by the game (LANDER_RECORD=file ./game) without
+*   a window and as fast as possible. The game code is the same, only the
+*   engine is replaced: keys are pressed and released by the record and dt
+*   comes from it, so the session repeats bit for bit. The hash of the last
+*   frame makes it easy to compare two runs.
+*
+*   Usage: replay_runner RECORD [--no-draw]
+*/
+
+int main(int argc, char **argv)
+{
+    bool draw_frames = true;
+    if (argc == 3 && std::strcmp(argv[2], "--no-draw") == 0)
+        draw_frames = false;
+    else if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " RECORD [--no-draw]\n";
+        return EXIT_FAILURE;
+    }
+
+    InputReplay replay;
+    if (!replay.open(argv[1]))
+    {
+        std::cerr << "Can't read the record " << argv[1] << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // The prediction overlay is timing dependent, frames must depend on the record only
+    set_session_seed(replay.get_seed());
+    set_prediction_enabled(false);
+    set_recording_enabled(false);
+    initialize();
+
+    float dt = 0;
+    std::vector<KeyEvent> events;
+    size_t frames_count = 0;
+    double game_time = 0;
+
+    // Same order of calls as in Engine.cpp
+    auto start = std::chrono::steady_clock::now();
+    while (replay.next_frame(dt, events))
+    {
+        for (const KeyEvent &event : events)
+            set_key_pressed(event.key, event.is_pressed);
+
+        act(dt);
+        ++frames_count;
+        game_time += dt;
+
+        if (is_quit_scheduled())
+            break;
+
+        if (draw_frames)
+            draw();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    finalize();
+
+    double seconds = elapsed.count();
+    std::cout << "seed:       " << replay.get_seed() << '\n'
+              << "frames:     " << frames_count << '\n'
+              << "game time:  " << game_time << " s\n"
+              << "time:       " << seconds << " s\n"
+              << "frames/sec: " << frames_count / seconds << '\n';
+
+    if (draw_frames)
+        std::cout << "frame hash: " << std::hex << hash_frame() << std::dec << '\n';
+
+    return EXIT_SUCCESS;
+}
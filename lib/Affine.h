@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "Vector.h"
+
+/*
+*   2D affine transform: point -> column_x * point.x + column_y * point.y + offset.
+*   Header only and constexpr except for the constructors from an angle. Composing
+*   transforms and applying them to points is a few multiply-adds with no branches,
+*   so the batch transform_points is vectorized by the compiler.
+*/
+template<typename T>
+struct Affine2 final
+{
+    using value_type = T;
+
+    Vector2<T> column_x;
+    Vector2<T> column_y;
+    Vector2<T> offset;
+
+    constexpr Affine2():
+        column_x(1, 0),
+        column_y(0, 1),
+        offset()
+        {}
+
+    constexpr explicit Affine2(Vector2<T> x_axis, Vector2<T> y_axis, Vector2<T> translation):
+        column_x(x_axis),
+        column_y(y_axis),
+        offset(translation)
+        {}
+
+    template<typename U>
+    constexpr explicit Affine2(const Affine2<U> &other):
+        column_x(other.column_x),
+        column_y(other.column_y),
+        offset(other.offset)
+        {}
+
+    static constexpr Affine2 translation(Vector2<T> position)
+    {
+        return Affine2(Vector2<T>(1, 0), Vector2<T>(0, 1), position);
+    }
+
+    static constexpr Affine2 from_sin_cos(T sin, T cos, Vector2<T> position = Vector2<T>())
+    {
+        return Affine2(Vector2<T>(cos, sin), Vector2<T>(-sin, cos), position);
+    }
+
+    static Affine2 rotation(T angle, Vector2<T> position = Vector2<T>())
+    {
+        return from_sin_cos(std::sin(angle), std::cos(angle), position);
+    }
+
+    // The transform of RectTransform: R(angle) * (point - pivot) + position
+    static constexpr Affine2 rotation_around(T sin, T cos, Vector2<T> pivot, Vector2<T> position)
+    {
+        Affine2 result = from_sin_cos(sin, cos);
+        result.offset = position - result.apply_linear(pivot);
+        return result;
+    }
+
+    constexpr Vector2<T> apply(Vector2<T> point) const
+    {
+        return column_x * point.x + column_y * point.y + offset;
+    }
+
+    // Applies only the linear part, for directions
+    constexpr Vector2<T> apply_linear(Vector2<T> direction) const
+    {
+        return column_x * direction.x + column_y * direction.y;
+    }
+
+    // out[i] = apply(in[i]) for the common prefix of in and out
+    constexpr void transform_points(std::span<const Vector2<T>> in, std::span<Vector2<T>> out) const
+    {
+        const size_t count = std::min(in.size(), out.size());
+        for (size_t i = 0; i < count; ++i)
+            out[i] = apply(in[i]);
+    }
+
+    constexpr T determinant() const
+    {
+        return column_x.x * column_y.y - column_y.x * column_x.y;
+    }
+
+    // The transform must not be degenerate
+    constexpr Affine2 inverse() const
+    {
+        const T inv_det = 1 / determinant();
+        Affine2 result(Vector2<T>( column_y.y, -column_x.y) * inv_det,
+                       Vector2<T>(-column_y.x,  column_x.x) * inv_det,
+                       Vector2<T>());
+        result.offset = -result.apply_linear(offset);
+        return result;
+    }
+
+    // First applies rhs, then this
+    constexpr Affine2 operator*(const Affine2 &rhs) const
+    {
+        return Affine2(apply_linear(rhs.column_x), apply_linear(rhs.column_y), apply(rhs.offset));
+    }
+};
+
+using Affine2d = Affine2<double>;
+using Affine2f = Affine2<float>;
+
+static_assert(std::is_trivially_copyable_v<Affine2d> && std::is_trivially_copyable_v<Affine2f>);
+static_assert((Affine2d::from_sin_cos(1, 0, Vector2d(2, 3)).inverse() * Affine2d::from_sin_cos(1, 0, Vector2d(2, 3)))
+              .apply(Vector2d(5, 7)).dot(Vector2d(1, 1)) == 12);
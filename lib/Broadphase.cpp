@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Broadphase.h"
+
+//----------------------------------------------------------------
+// Broadphase
+//----------------------------------------------------------------
+
+uint32_t Broadphase::add_proxy(const AABB &box, uint32_t body_id)
+{
+    uint32_t proxy_id = 0;
+    if (!free_proxies_.empty())
+    {
+        proxy_id = free_proxies_.back();
+        free_proxies_.pop_back();
+    }
+    else
+    {
+        proxy_id = proxies_.size();
+        proxies_.emplace_back();
+    }
+
+    proxies_[proxy_id] = {box, body_id, true};
+    on_add(proxy_id);
+
+    return proxy_id;
+}
+
+void Broadphase::remove_proxy(uint32_t proxy_id)
+{
+    on_remove(proxy_id);
+    proxies_[proxy_id].alive = false;
+    free_proxies_.push_back(proxy_id);
+}
+
+void Broadphase::update_proxy(uint32_t proxy_id, const AABB &box)
+{
+    AABB old_box = proxies_[proxy_id].box;
+    proxies_[proxy_id].box = box;
+    on_update(proxy_id, old_box);
+}
+
+const AABB &Broadphase::get_box(uint32_t proxy_id) const
+{
+    return proxies_[proxy_id].box;
+}
+
+uint32_t Broadphase::get_body(uint32_t proxy_id) const
+{
+    return proxies_[proxy_id].body_id;
+}
+
+bool Broadphase::can_collide(uint32_t first, uint32_t second) const
+{
+    return proxies_[first].body_id != proxies_[second].body_id &&
+           proxies_[first].box.is_intersect(proxies_[second].box);
+}
+
+//----------------------------------------------------------------
+// Sweep and prune
+//----------------------------------------------------------------
+
+void SweepAndPrune::find_pairs(std::vector<ProxyPair> &pairs)
+{
+    pairs.clear();
+
+    // Insertion sort: O(n + number of swaps) for the nearly sorted order
+    for (size_t i = 1; i < sorted_.size(); ++i)
+    {
+        uint32_t proxy_id = sorted_[i];
+        double left = proxies_[proxy_id].box.left;
+
+        size_t j = i;
+        for (; j > 0 && proxies_[sorted_[j - 1]].box.left > left; --j)
+            sorted_[j] = sorted_[j - 1];
+        sorted_[j] = proxy_id;
+    }
+
+    for (size_t i = 0; i < sorted_.size(); ++i)
+    {
+        uint32_t first = sorted_[i];
+        double right = proxies_[first].box.right;
+
+        for (size_t j = i + 1; j < sorted_.size() && proxies_[sorted_[j]].box.left <= right; ++j)
+        {
+            uint32_t second = sorted_[j];
+            if (can_collide(first, second))
+                pairs.emplace_back(std::min(first, second), std::max(first, second));
+        }
+    }
+}
+
+void SweepAndPrune::on_add(uint32_t proxy_id)
+{
+    sorted_.push_back(proxy_id);
+}
+
+void SweepAndPrune::on_remove(uint32_t proxy_id)
+{
+    sorted_.erase(std::find(sorted_.begin(), sorted_.end(), proxy_id));
+}
+
+void SweepAndPrune::on_update(uint32_t, const AABB &) {}
+
+//----------------------------------------------------------------
+// Spatial hash
+//----------------------------------------------------------------
+
+SpatialHash::SpatialHash(double cell_size):
+    Broadphase(),
+    cell_size_(cell_size),
+    cells_()
+    {}
+
+void SpatialHash::find_pairs(std::vector<ProxyPair> &pairs)
+{
+    pairs.clear();
+
+    for (const auto &[key, cell] : cells_)
+    {
+        int32_t cell_x = static_cast<int32_t>(key >> 32);
+        int32_t cell_y = static_cast<int32_t>(key & 0xFFFFFFFF);
+
+        for (size_t i = 0; i < cell.size(); ++i)
+        {
+            CellRange first_range = get_cell_range(proxies_[cell[i]].box);
+            for (size_t j = i + 1; j < cell.size(); ++j)
+            {
+                if (!can_collide(cell[i], cell[j]))
+                    continue;
+
+                // Report the pair only from the first cell both boxes cover
+                CellRange second_range = get_cell_range(proxies_[cell[j]].box);
+                if (cell_x != std::max(first_range.x_min, second_range.x_min) ||
+                    cell_y != std::max(first_range.y_min, second_range.y_min))
+                    continue;
+
+                pairs.emplace_back(std::min(cell[i], cell[j]), std::max(cell[i], cell[j]));
+            }
+        }
+    }
+}
+
+SpatialHash::CellRange SpatialHash::get_cell_range(const AABB &box) const
+{
+    return {static_cast<int32_t>(std::floor(box.left   / cell_size_)),
+            static_cast<int32_t>(std::floor(box.bottom / cell_size_)),
+            static_cast<int32_t>(std::floor(box.right  / cell_size_)),
+            static_cast<int32_t>(std::floor(box.top    / cell_size_))};
+}
+
+uint64_t SpatialHash::get_cell_key(int32_t x, int32_t y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void SpatialHash::insert(uint32_t proxy_id, const CellRange &range)
+{
+    for (int32_t x = range.x_min; x <= range.x_max; ++x)
+        for (int32_t y = range.y_min; y <= range.y_max; ++y)
+            cells_[get_cell_key(x, y)].push_back(proxy_id);
+}
+
+void SpatialHash::erase(uint32_t proxy_id, const CellRange &range)
+{
+    for (int32_t x = range.x_min; x <= range.x_max; ++x)
+    {
+        for (int32_t y = range.y_min; y <= range.y_max; ++y)
+        {
+            auto cell = cells_.find(get_cell_key(x, y));
+            if (cell == cells_.end())
+                continue;
+
+            auto &ids = cell->second;
+            auto it = std::find(ids.begin(), ids.end(), proxy_id);
+            if (it != ids.end())
+            {
+                *it = ids.back();
+                ids.pop_back();
+            }
+            if (ids.empty())
+                cells_.erase(cell);
+        }
+    }
+}
+
+void SpatialHash::on_add(uint32_t proxy_id)
+{
+    insert(proxy_id, get_cell_range(proxies_[proxy_id].box));
+}
+
+void SpatialHash::on_remove(uint32_t proxy_id)
+{
+    erase(proxy_id, get_cell_range(proxies_[proxy_id].box));
+}
+
+void SpatialHash::on_update(uint32_t proxy_id, const AABB &old_box)
+{
+    CellRange old_range = get_cell_range(old_box);
+    CellRange new_range = get_cell_range(proxies_[proxy_id].box);
+    if (old_range == new_range)
+        return;
+
+    erase (proxy_id, old_range);
+    insert(proxy_id, new_range);
+}
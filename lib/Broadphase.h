@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Collider.h"
+
+/*
+*   Broadphase keeps the AABBs of many dynamic colliders and reports the
+*   pairs whose boxes overlap, to be checked by the SAT narrowphase
+*   (Collider::check_collision). Every collider is registered as a proxy with
+*   the id of its body; proxies of the same body never form a pair.
+*/
+class Broadphase
+{
+    public:
+        using ProxyPair = std::pair<uint32_t, uint32_t>;
+
+        virtual ~Broadphase() = default;
+
+        uint32_t add_proxy(const AABB &box, uint32_t body_id);
+        void remove_proxy(uint32_t proxy_id);
+        void update_proxy(uint32_t proxy_id, const AABB &box);
+
+        const AABB &get_box(uint32_t proxy_id) const;
+        uint32_t get_body(uint32_t proxy_id) const;
+
+        // Pairs (first < second) of overlapping proxies of different bodies
+        virtual void find_pairs(std::vector<ProxyPair> &pairs) = 0;
+
+    protected:
+        struct Proxy
+        {
+            AABB box;
+            uint32_t body_id = 0;
+            bool alive = false;
+        };
+
+        std::vector<Proxy> proxies_;
+        std::vector<uint32_t> free_proxies_;
+
+        virtual void on_add   (uint32_t proxy_id) = 0;
+        virtual void on_remove(uint32_t proxy_id) = 0;
+        virtual void on_update(uint32_t proxy_id, const AABB &old_box) = 0;
+
+        bool can_collide(uint32_t first, uint32_t second) const;
+};
+
+/*
+*   Proxies are kept sorted by the left side of their boxes. Between frames
+*   boxes move little, so insertion sort restores the order in nearly O(n);
+*   the sweep then only visits boxes overlapping on x.
+*/
+class SweepAndPrune final : public Broadphase
+{
+    public:
+        virtual void find_pairs(std::vector<ProxyPair> &pairs) override;
+
+    private:
+        std::vector<uint32_t> sorted_;
+
+        virtual void on_add   (uint32_t proxy_id) override;
+        virtual void on_remove(uint32_t proxy_id) override;
+        virtual void on_update(uint32_t proxy_id, const AABB &old_box) override;
+};
+
+/*
+*   Uniform grid stored in a hash map. A proxy is re-inserted only when the
+*   range of cells it covers changes. A pair is reported only from the first
+*   cell both boxes share, so no deduplication is needed.
+*/
+class SpatialHash final : public Broadphase
+{
+    public:
+        explicit SpatialHash(double cell_size);
+
+        virtual void find_pairs(std::vector<ProxyPair> &pairs) override;
+
+    private:
+        struct CellRange
+        {
+            int32_t x_min;
+            int32_t y_min;
+            int32_t x_max;
+            int32_t y_max;
+
+            bool operator==(const CellRange &other) const = default;
+        };
+
+        double cell_size_;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+
+        CellRange get_cell_range(const AABB &box) const;
+        static uint64_t get_cell_key(int32_t x, int32_t y);
+
+        void insert(uint32_t proxy_id, const CellRange &range);
+        void erase (uint32_t proxy_id, const CellRange &range);
+
+        virtual void on_add   (uint32_t proxy_id) override;
+        virtual void on_remove(uint32_t proxy_id) override;
+        virtual void on_update(uint32_t proxy_id, const AABB &old_box) override;
+};
@@ -0,0 +1,5 @@
+#include "CapsuleCollider.h"
+
+CapsuleCollider::CapsuleCollider(double length, double radius, Vector2d position, Vector2d pivot, double angle):
+    ConvexCollider<2>({Vector2d(0, 0), Vector2d(length, 0)}, radius, position, pivot, angle)
+    {}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "ConvexCollider.h"
+
+// Segment from (0, 0) to (length, 0) in local coordinates inflated by the radius
+class CapsuleCollider final : public ConvexCollider<2>
+{
+    public:
+        CapsuleCollider(double length, double radius, Vector2d position = Vector2d(), Vector2d pivot = Vector2d(), double angle = 0.0);
+};
@@ -0,0 +1,5 @@
+#include "CircleCollider.h"
+
+CircleCollider::CircleCollider(double radius, Vector2d position):
+    ConvexCollider<1>({Vector2d(0, 0)}, radius, position)
+    {}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "ConvexCollider.h"
+
+// A single vertex at the center inflated by the radius
+class CircleCollider final : public ConvexCollider<1>
+{
+    public:
+        CircleCollider(double radius, Vector2d position = Vector2d());
+};
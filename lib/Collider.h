@@ -30,23 +30,19 @@ struct AABB final
     bool is_intersect(const AABB &other) const;
 };
 
-class RectCollider;
-
+/*
+*   Common part of the shape colliders: the bounding box used for early outs.
+*   Shapes are dispatched statically (see ShapeCollider), so there are no virtual functions here.
+*/
 class Collider
 {
     public:
-        virtual ~Collider() = default;
-
         const AABB &get_AABB() const;
 
         bool check_AABB_AABB_collision(const AABB &other) const;
         bool check_AABB_segment_collision(const Segment &other) const;
 
-        virtual std::pair<bool, Vector2d> check_collision(const Segment& other) const = 0;
-        virtual std::pair<bool, Vector2d> check_collision(const RectCollider& other) const = 0;
-
-        friend class RectCollider;
-    private:
+    protected:
         AABB box_;
 };
 
@@ -1,3 +1,8 @@
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLOR_SPAN_X86
+#endif
+
 #include "Color.h"
 
 Color::Color(uint32_t color):
@@ -75,15 +80,187 @@ Color::operator uint32_t() const
     return get_color();
 }
 
+namespace
+{
+    // Same arithmetic as Color::blend, result is always opaque
+    inline uint32_t blend_pixel(uint32_t src, uint32_t dst)
+    {
+        uint32_t alpha     = src >> 24;
+        uint32_t inv_alpha = 255 - alpha;
+
+        uint32_t red   = (((src >> 16) & 0xFF) * alpha + ((dst >> 16) & 0xFF) * inv_alpha) >> 8;
+        uint32_t green = (((src >>  8) & 0xFF) * alpha + ((dst >>  8) & 0xFF) * inv_alpha) >> 8;
+        uint32_t blue  = (((src      ) & 0xFF) * alpha + ((dst      ) & 0xFF) * inv_alpha) >> 8;
+
+        return Color::Black | (red << 16) | (green << 8) | blue;
+    }
+
+    void blend_span_scalar(uint32_t *dst, const uint32_t *src, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = blend_pixel(src[i], dst[i]);
+    }
+
+    void fill_blend_span_scalar(uint32_t *dst, uint32_t color, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = blend_pixel(color, dst[i]);
+    }
+
+#ifdef COLOR_SPAN_X86
+    /*
+    *   Channels are widened to 16 bits: src * alpha + dst * (255 - alpha) never
+    *   exceeds 255 * 255, so the sum and the logical shift by 8 are exact.
+    */
+    __attribute__((target("sse2")))
+    inline __m128i blend_sse2(__m128i src, __m128i dst)
+    {
+        const __m128i zero   = _mm_setzero_si128();
+        const __m128i max    = _mm_set1_epi16(255);
+        const __m128i opaque = _mm_set1_epi32(Color::Black);
+
+        __m128i src_lo = _mm_unpacklo_epi8(src, zero);
+        __m128i src_hi = _mm_unpackhi_epi8(src, zero);
+        __m128i dst_lo = _mm_unpacklo_epi8(dst, zero);
+        __m128i dst_hi = _mm_unpackhi_epi8(dst, zero);
+
+        __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_lo, 0xFF), 0xFF);
+        __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_hi, 0xFF), 0xFF);
+
+        __m128i res_lo = _mm_add_epi16(_mm_mullo_epi16(src_lo, alpha_lo),
+                                       _mm_mullo_epi16(dst_lo, _mm_sub_epi16(max, alpha_lo)));
+        __m128i res_hi = _mm_add_epi16(_mm_mullo_epi16(src_hi, alpha_hi),
+                                       _mm_mullo_epi16(dst_hi, _mm_sub_epi16(max, alpha_hi)));
+
+        __m128i result = _mm_packus_epi16(_mm_srli_epi16(res_lo, 8), _mm_srli_epi16(res_hi, 8));
+        return _mm_or_si128(result, opaque);
+    }
+
+    __attribute__((target("sse2")))
+    void blend_span_sse2(uint32_t *dst, const uint32_t *src, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), blend_sse2(s, d));
+        }
+        blend_span_scalar(dst + i, src + i, count - i);
+    }
+
+    __attribute__((target("sse2")))
+    void fill_blend_span_sse2(uint32_t *dst, uint32_t color, size_t count)
+    {
+        const __m128i s = _mm_set1_epi32(color);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), blend_sse2(s, d));
+        }
+        fill_blend_span_scalar(dst + i, color, count - i);
+    }
+
+    // Unpack, shuffle and pack work inside 128-bit lanes, so pixel order is kept
+    __attribute__((target("avx2")))
+    inline __m256i blend_avx2(__m256i src, __m256i dst)
+    {
+        const __m256i zero   = _mm256_setzero_si256();
+        const __m256i max    = _mm256_set1_epi16(255);
+        const __m256i opaque = _mm256_set1_epi32(Color::Black);
+
+        __m256i src_lo = _mm256_unpacklo_epi8(src, zero);
+        __m256i src_hi = _mm256_unpackhi_epi8(src, zero);
+        __m256i dst_lo = _mm256_unpacklo_epi8(dst, zero);
+        __m256i dst_hi = _mm256_unpackhi_epi8(dst, zero);
+
+        __m256i alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src_lo, 0xFF), 0xFF);
+        __m256i alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src_hi, 0xFF), 0xFF);
+
+        __m256i res_lo = _mm256_add_epi16(_mm256_mullo_epi16(src_lo, alpha_lo),
+                                          _mm256_mullo_epi16(dst_lo, _mm256_sub_epi16(max, alpha_lo)));
+        __m256i res_hi = _mm256_add_epi16(_mm256_mullo_epi16(src_hi, alpha_hi),
+                                          _mm256_mullo_epi16(dst_hi, _mm256_sub_epi16(max, alpha_hi)));
+
+        __m256i result = _mm256_packus_epi16(_mm256_srli_epi16(res_lo, 8), _mm256_srli_epi16(res_hi, 8));
+        return _mm256_or_si256(result, opaque);
+    }
+
+    __attribute__((target("avx2")))
+    void blend_span_avx2(uint32_t *dst, const uint32_t *src, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), blend_avx2(s, d));
+        }
+        blend_span_sse2(dst + i, src + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void fill_blend_span_avx2(uint32_t *dst, uint32_t color, size_t count)
+    {
+        const __m256i s = _mm256_set1_epi32(color);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), blend_avx2(s, d));
+        }
+        fill_blend_span_sse2(dst + i, color, count - i);
+    }
+#endif
+
+    using blend_span_t      = void (*)(uint32_t *, const uint32_t *, size_t);
+    using fill_blend_span_t = void (*)(uint32_t *, uint32_t, size_t);
+
+    struct BlendKernels
+    {
+        blend_span_t      blend = blend_span_scalar;
+        fill_blend_span_t fill  = fill_blend_span_scalar;
+
+        BlendKernels()
+        {
+#ifdef COLOR_SPAN_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                blend = blend_span_avx2;
+                fill  = fill_blend_span_avx2;
+            }
+            else if (__builtin_cpu_supports("sse2"))
+            {
+                blend = blend_span_sse2;
+                fill  = fill_blend_span_sse2;
+            }
+#endif
+        }
+    };
+
+    const BlendKernels &get_blend_kernels()
+    {
+        static const BlendKernels kernels;
+        return kernels;
+    }
+}
+
 // Assumes that background is no transparent
 Color Color::blend(Color background) const
 {
-    auto alpha_1 = get_alpha();
-    Color result = Color(
-        (get_red  () * alpha_1 + background.get_red  () * (255 - alpha_1)) >> 8,
-        (get_green() * alpha_1 + background.get_green() * (255 - alpha_1)) >> 8,
-        (get_blue () * alpha_1 + background.get_blue () * (255 - alpha_1)) >> 8
-    );
-
-    return result;
+    return blend_pixel(color_, background.color_);
+}
+
+void Color::blend_span(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    get_blend_kernels().blend(dst, src, count);
+}
+
+void Color::fill_blend_span(uint32_t *dst, Color color, size_t count)
+{
+    get_blend_kernels().fill(dst, color, count);
 }
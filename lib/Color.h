@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 class Color final
@@ -26,6 +27,14 @@ class Color final
 
         Color blend(Color other) const;
 
+        /*
+        *   Span versions of blend: dst[i] = src[i].blend(dst[i]) and
+        *   dst[i] = color.blend(dst[i]). SSE2/AVX2 kernels are picked at runtime,
+        *   results are bit identical to blend.
+        */
+        static void blend_span(uint32_t *dst, const uint32_t *src, size_t count);
+        static void fill_blend_span(uint32_t *dst, Color color, size_t count);
+
     private:
         uint32_t color_;
 
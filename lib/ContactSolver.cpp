@@ -0,0 +1,186 @@
+#include <algorithm>
+
+#include "ContactSolver.h"
+
+namespace
+{
+    double cross(Vector2d lhs, Vector2d rhs)
+    {
+        return lhs.x * rhs.y - lhs.y * rhs.x;
+    }
+}
+
+ContactSolver::ContactSolver(size_t iterations, double friction):
+    points_(),
+    old_points_(),
+    iterations_(iterations),
+    friction_(friction)
+    {}
+
+void ContactSolver::update_manifold(const std::vector<ShapeCollider> &colliders, const std::vector<Contact> &contacts)
+{
+    std::swap(points_, old_points_);
+    points_.clear();
+    std::sort(old_points_.begin(), old_points_.end(),
+              [](const ContactPoint &lhs, const ContactPoint &rhs) { return lhs.key < rhs.key; });
+
+    for (const Contact &contact : contacts)
+    {
+        colliders[contact.collider_id].visit([this, &contact](const auto &shape)
+        {
+            add_points(contact.collider_id, shape, contact);
+        });
+    }
+}
+
+/*
+*   Points are the collider vertices (pushed out by the radius) that are
+*   below the segment line and over the segment. If the segment pokes into
+*   a side of the collider there are none, then the deepest vertex is taken
+*   with the depth of the mtv.
+*/
+template<size_t number_of_vertices>
+void ContactSolver::add_points(uint32_t collider_id, const ConvexCollider<number_of_vertices> &collider, const Contact &contact)
+{
+    const Vector2d &normal = contact.info.normal;
+    const Vector2d tangent = normal.normal();
+    const Vector2d a(contact.segment.a_x, contact.segment.a_y);
+    const Vector2d b(contact.segment.b_x, contact.segment.b_y);
+
+    const double radius = collider.get_radius();
+    const double plane  = normal.dot(a);
+    const double tangent_min = std::min(tangent.dot(a), tangent.dot(b)) - radius;
+    const double tangent_max = std::max(tangent.dot(a), tangent.dot(b)) + radius;
+
+    const auto &vertices = collider.get_vertices();
+    size_t added = 0;
+    size_t deepest_id = 0;
+    double deepest = 0;
+    for (size_t vertex_id = 0; vertex_id < number_of_vertices; ++vertex_id)
+    {
+        Vector2d point = vertices[vertex_id] - normal * radius;
+        double depth = plane - normal.dot(point);
+        if (vertex_id == 0 || depth > deepest)
+        {
+            deepest_id = vertex_id;
+            deepest = depth;
+        }
+
+        double tangent_coord = tangent.dot(point);
+        if (depth > 0 && tangent_min <= tangent_coord && tangent_coord <= tangent_max)
+        {
+            add_point(make_key(collider_id, contact.segment_id, vertex_id), point, normal, depth);
+            ++added;
+        }
+    }
+
+    if (added == 0)
+    {
+        Vector2d point = vertices[deepest_id] - normal * radius;
+        add_point(make_key(collider_id, contact.segment_id, deepest_id), point, normal, contact.info.mtv.dot(normal));
+    }
+}
+
+void ContactSolver::add_point(uint64_t key, Vector2d point, Vector2d normal, double depth)
+{
+    ContactPoint contact_point{key, point, normal, depth, 0, 0, Vector2d(), Vector2d(), 0, 0};
+
+    auto old = std::lower_bound(old_points_.begin(), old_points_.end(), key,
+                                [](const ContactPoint &lhs, uint64_t key) { return lhs.key < key; });
+    if (old != old_points_.end() && old->key == key)
+    {
+        contact_point.normal_impulse  = old->normal_impulse;
+        contact_point.tangent_impulse = old->tangent_impulse;
+    }
+
+    points_.push_back(contact_point);
+}
+
+Vector2d ContactSolver::solve(BodyState &body)
+{
+    for (ContactPoint &point : points_)
+    {
+        point.offset  = point.point - body.center;
+        point.tangent = point.normal.normal();
+
+        double offset_normal  = cross(point.offset, point.normal);
+        double offset_tangent = cross(point.offset, point.tangent);
+        double normal_mass    = body.inverse_mass + body.inverse_inertia * offset_normal  * offset_normal;
+        double tangent_mass   = body.inverse_mass + body.inverse_inertia * offset_tangent * offset_tangent;
+        point.normal_mass  = normal_mass  > 0 ? 1 / normal_mass  : 0;
+        point.tangent_mass = tangent_mass > 0 ? 1 / tangent_mass : 0;
+
+        // Warm starting: the impulses of the last frame are applied at once
+        apply_impulse(body, point, point.normal * point.normal_impulse + point.tangent * point.tangent_impulse);
+    }
+
+    auto point_velocity = [&body](const ContactPoint &point)
+    {
+        return body.velocity + Vector2d(-body.angular_velocity * point.offset.y, body.angular_velocity * point.offset.x);
+    };
+
+    for (size_t iteration = 0; iteration < iterations_; ++iteration)
+    {
+        for (ContactPoint &point : points_)
+        {
+            // Friction is bounded by the normal impulse of the previous iteration
+            double tangent_speed = point_velocity(point).dot(point.tangent);
+            double max_friction  = friction_ * point.normal_impulse;
+            double old_tangent_impulse = point.tangent_impulse;
+            point.tangent_impulse = std::clamp(old_tangent_impulse - tangent_speed * point.tangent_mass, -max_friction, max_friction);
+            apply_impulse(body, point, point.tangent * (point.tangent_impulse - old_tangent_impulse));
+
+            // The ground only pushes, so the total normal impulse stays non negative
+            double normal_speed = point_velocity(point).dot(point.normal);
+            double old_normal_impulse = point.normal_impulse;
+            point.normal_impulse = std::max(old_normal_impulse - normal_speed * point.normal_mass, 0.0);
+            apply_impulse(body, point, point.normal * (point.normal_impulse - old_normal_impulse));
+        }
+    }
+
+    // Penetration is projected out along the normals, leaving a bit to keep the contacts
+    Vector2d translation;
+    for (size_t iteration = 0; iteration < iterations_; ++iteration)
+    {
+        for (const ContactPoint &point : points_)
+        {
+            double depth = point.depth - point.normal.dot(translation);
+            if (depth > Allowed_penetration_)
+                translation += point.normal * (depth - Allowed_penetration_);
+        }
+    }
+
+    return translation;
+}
+
+void ContactSolver::clear()
+{
+    points_.clear();
+    old_points_.clear();
+}
+
+size_t ContactSolver::get_points_count() const
+{
+    return points_.size();
+}
+
+void ContactSolver::set_iterations(size_t iterations)
+{
+    iterations_ = iterations;
+}
+
+void ContactSolver::set_friction(double friction)
+{
+    friction_ = friction;
+}
+
+void ContactSolver::apply_impulse(BodyState &body, const ContactPoint &point, Vector2d impulse)
+{
+    body.velocity += impulse * body.inverse_mass;
+    body.angular_velocity += body.inverse_inertia * cross(point.offset, impulse);
+}
+
+uint64_t ContactSolver::make_key(uint32_t collider_id, uint32_t segment_id, uint32_t vertex_id)
+{
+    return static_cast<uint64_t>(collider_id) << 48 | static_cast<uint64_t>(segment_id) << 16 | vertex_id;
+}
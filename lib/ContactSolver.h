@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Narrowphase.h"
+#include "ShapeCollider.h"
+
+// Velocity state of a body the solver pushes out of the static ground
+struct BodyState
+{
+    Vector2d center;
+    Vector2d velocity;
+    double angular_velocity;
+    double inverse_mass;
+    double inverse_inertia;
+};
+
+/*
+*   Sequential impulse solver for a body resting on the ground. Every contact
+*   of the narrowphase gives up to one point per collider vertex; a point is
+*   keyed by (collider, segment, vertex), so it keeps its accumulated impulses
+*   from the previous frame and the solver starts from them (warm starting).
+*   Penetration is removed by a translation returned from solve instead of a
+*   velocity bias, so that pushing out does not look like an impact.
+*/
+class ContactSolver final
+{
+    public:
+        ContactSolver(size_t iterations = Default_iterations, double friction = Default_friction);
+
+        // Rebuilds the points from the contacts of this frame, reusing the impulses of matching points
+        void update_manifold(const std::vector<ShapeCollider> &colliders, const std::vector<Contact> &contacts);
+
+        // Changes velocities of the body, returns the translation that takes it out of the ground
+        Vector2d solve(BodyState &body);
+
+        void clear();
+
+        size_t get_points_count() const;
+
+        void set_iterations(size_t iterations);
+        void set_friction(double friction);
+
+        static constexpr size_t Default_iterations = 4;
+        static constexpr double Default_friction   = 0.5;
+
+    private:
+        struct ContactPoint
+        {
+            uint64_t key;
+            Vector2d point;
+            Vector2d normal;
+            double depth;
+
+            // Accumulated over iterations and carried to the next frame
+            double normal_impulse;
+            double tangent_impulse;
+
+            // Filled before the iterations
+            Vector2d offset;
+            Vector2d tangent;
+            double normal_mass;
+            double tangent_mass;
+        };
+
+        std::vector<ContactPoint> points_;
+        std::vector<ContactPoint> old_points_;
+
+        size_t iterations_;
+        double friction_;
+
+        template<size_t number_of_vertices>
+        void add_points(uint32_t collider_id, const ConvexCollider<number_of_vertices> &collider, const Contact &contact);
+
+        void add_point(uint64_t key, Vector2d point, Vector2d normal, double depth);
+        static void apply_impulse(BodyState &body, const ContactPoint &point, Vector2d impulse);
+
+        static uint64_t make_key(uint32_t collider_id, uint32_t segment_id, uint32_t vertex_id);
+
+        // Penetration left to keep the contacts alive between frames
+        static constexpr double Allowed_penetration_ = 0.1;
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+
+#include "Collider.h"
+#include "RectTransform.h"
+#include "SAT.h"
+
+/*
+*   Convex polygon collider with a number of vertices known at compile time,
+*   optionally inflated by a radius. Local vertices go around the polygon in
+*   order and are placed with the transform: world = R(angle) * (local - pivot) + position.
+*/
+template<size_t number_of_vertices>
+class ConvexCollider : public Collider
+{
+    public:
+        static constexpr size_t Number_of_vertices = number_of_vertices;
+        using polygon_t = std::array<Vector2d, Number_of_vertices>;
+
+        ConvexCollider(const polygon_t &local_vertices, double radius = 0.0, Vector2d position = Vector2d(),
+                       Vector2d pivot = Vector2d(), double angle = 0.0);
+
+        std::pair<bool, Vector2d> check_collision(const Segment &other) const;
+
+        template<size_t other_vertices>
+        std::pair<bool, Vector2d> check_collision(const ConvexCollider<other_vertices> &other) const;
+
+        void move(double x, double y);
+        void move(Vector2d offset);
+
+        void rotate(double angle);
+
+        void set_position(Vector2d position);
+        void set_angle(double angle);
+        void set_pivot(Vector2d pivot);
+
+        // Places the collider at once, computing the vertices and the AABB a single time
+        void set_transform(Vector2d position, double angle);
+
+        const RectTransform &get_transform() const;
+
+        const polygon_t &get_vertices() const;
+        double get_radius() const;
+
+        // The farthest point of the shape in the given direction
+        Vector2d get_support_point(Vector2d direction) const;
+
+        // The smallest width of the shape over all directions
+        double get_thickness() const;
+
+    private:
+        RectTransform transform_;
+        polygon_t local_vertices_;
+        double radius_;
+
+        void update_AABB();
+
+        mutable bool need_update_vertices_;
+        mutable polygon_t transformed_vertices_;
+        void update_vertices() const;
+
+        static Vector2d get_size(const polygon_t &local_vertices, double radius);
+};
+
+template<size_t number_of_vertices>
+ConvexCollider<number_of_vertices>::ConvexCollider(const polygon_t &local_vertices, double radius, Vector2d position,
+                                                   Vector2d pivot, double angle):
+    Collider(),
+    transform_(get_size(local_vertices, radius), position, pivot, angle),
+    local_vertices_(local_vertices),
+    radius_(radius),
+    need_update_vertices_(true),
+    transformed_vertices_()
+    { update_AABB(); }
+
+template<size_t number_of_vertices>
+std::pair<bool, Vector2d> ConvexCollider<number_of_vertices>::check_collision(const Segment &other) const
+{
+    if (!box_.is_intersect(AABB(other)))
+        return {false, Vector2d()};
+
+    const std::array<Vector2d, 2> segment_vertices = {Vector2d(other.a_x, other.a_y), Vector2d(other.b_x, other.b_y)};
+
+    auto [axis_exists, mtv] = SAT_check(get_vertices(), radius_, segment_vertices, 0.0);
+    return {!axis_exists, mtv};
+}
+
+template<size_t number_of_vertices>
+template<size_t other_vertices>
+std::pair<bool, Vector2d> ConvexCollider<number_of_vertices>::check_collision(const ConvexCollider<other_vertices> &other) const
+{
+    if (!box_.is_intersect(other.get_AABB()))
+        return {false, Vector2d()};
+
+    auto [axis_exists, mtv] = SAT_check(get_vertices(), radius_, other.get_vertices(), other.get_radius());
+    return {!axis_exists, mtv};
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::move(double x, double y)
+{
+    transform_.move(x, y);
+    box_.left   += x;
+    box_.right  += x;
+    box_.top    += y;
+    box_.bottom += y;
+
+    for (auto &vertex : transformed_vertices_)
+        vertex += Vector2d(x, y);
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::move(Vector2d offset)
+{
+    move(offset.x, offset.y);
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::rotate(double angle)
+{
+    transform_.rotate(angle);
+    need_update_vertices_ = true;
+    update_AABB();
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::set_position(Vector2d position)
+{
+    move(position - transform_.get_position());
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::set_angle(double angle)
+{
+    transform_.set_angle(angle);
+    need_update_vertices_ = true;
+    update_AABB();
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::set_pivot(Vector2d pivot)
+{
+    transform_.set_pivot(pivot);
+    need_update_vertices_ = true;
+    update_AABB();
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::set_transform(Vector2d position, double angle)
+{
+    transform_.set_position(position);
+    transform_.set_angle(angle);
+    need_update_vertices_ = true;
+    update_AABB();
+}
+
+template<size_t number_of_vertices>
+const RectTransform &ConvexCollider<number_of_vertices>::get_transform() const
+{
+    return transform_;
+}
+
+template<size_t number_of_vertices>
+const typename ConvexCollider<number_of_vertices>::polygon_t &ConvexCollider<number_of_vertices>::get_vertices() const
+{
+    update_vertices();
+    return transformed_vertices_;
+}
+
+template<size_t number_of_vertices>
+double ConvexCollider<number_of_vertices>::get_radius() const
+{
+    return radius_;
+}
+
+template<size_t number_of_vertices>
+Vector2d ConvexCollider<number_of_vertices>::get_support_point(Vector2d direction) const
+{
+    const polygon_t &vertices = get_vertices();
+
+    Vector2d support = vertices[0];
+    double max_dot = support.dot(direction);
+    for (size_t i = 1; i < Number_of_vertices; ++i)
+    {
+        double cur_dot = vertices[i].dot(direction);
+        if (cur_dot > max_dot)
+        {
+            support = vertices[i];
+            max_dot = cur_dot;
+        }
+    }
+
+    double length = direction.norm();
+    if (radius_ > 0 && length > 0)
+        support += direction * (radius_ / length);
+
+    return support;
+}
+
+template<size_t number_of_vertices>
+double ConvexCollider<number_of_vertices>::get_thickness() const
+{
+    if constexpr (Number_of_vertices < 3)
+        return 2 * radius_;
+
+    // For a convex polygon the minimal width is reached across one of its edges
+    double thickness = std::numeric_limits<double>::max();
+    for (size_t edge_id = 0; edge_id < Number_of_vertices; ++edge_id)
+    {
+        Vector2d axis = (local_vertices_[(edge_id + 1) % Number_of_vertices] - local_vertices_[edge_id]).normal();
+        if (axis.norm_sq() == 0)
+            continue;
+
+        axis.normalize();
+        Vector2d projection = get_min_max_projection_coord(local_vertices_, axis);
+        thickness = std::min(thickness, projection.y - projection.x);
+    }
+
+    return thickness + 2 * radius_;
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::update_AABB()
+{
+    const polygon_t &vertices = get_vertices();
+
+    double left   = vertices[0].x;
+    double right  = vertices[0].x;
+    double top    = vertices[0].y;
+    double bottom = vertices[0].y;
+    for (const Vector2d &vertex : vertices)
+    {
+        left   = std::min(left  , vertex.x);
+        right  = std::max(right , vertex.x);
+        top    = std::max(top   , vertex.y);
+        bottom = std::min(bottom, vertex.y);
+    }
+
+    box_ = AABB(left - radius_, right + radius_, top + radius_, bottom - radius_);
+}
+
+template<size_t number_of_vertices>
+void ConvexCollider<number_of_vertices>::update_vertices() const
+{
+    if (!need_update_vertices_)
+        return;
+
+    transform_.get_matrix().transform_points(local_vertices_, transformed_vertices_);
+
+    need_update_vertices_ = false;
+}
+
+// Size of the local bounding box, kept in the transform for the users of RectTransform
+template<size_t number_of_vertices>
+Vector2d ConvexCollider<number_of_vertices>::get_size(const polygon_t &local_vertices, double radius)
+{
+    Vector2d x_range = get_min_max_projection_coord(local_vertices, Vector2d(1, 0));
+    Vector2d y_range = get_min_max_projection_coord(local_vertices, Vector2d(0, 1));
+
+    return Vector2d(x_range.y - x_range.x + 2 * radius, y_range.y - y_range.x + 2 * radius);
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+
+#include "DamageTracker.h"
+
+ScreenRect::ScreenRect(int left_bound, int top_bound, int right_bound, int bottom_bound):
+    left(left_bound),
+    top(top_bound),
+    right(right_bound),
+    bottom(bottom_bound)
+    {}
+
+int ScreenRect::get_width() const
+{
+    return std::max(right - left, 0);
+}
+
+int ScreenRect::get_height() const
+{
+    return std::max(bottom - top, 0);
+}
+
+size_t ScreenRect::get_area() const
+{
+    return static_cast<size_t>(get_width()) * get_height();
+}
+
+bool ScreenRect::is_empty() const
+{
+    return left >= right || top >= bottom;
+}
+
+bool ScreenRect::is_intersect(const ScreenRect &other) const
+{
+    return !intersect(other).is_empty();
+}
+
+ScreenRect ScreenRect::intersect(const ScreenRect &other) const
+{
+    return ScreenRect(std::max(left , other.left ), std::max(top   , other.top   ),
+                      std::min(right, other.right), std::min(bottom, other.bottom));
+}
+
+ScreenRect ScreenRect::unite(const ScreenRect &other) const
+{
+    if (is_empty())
+        return other;
+    if (other.is_empty())
+        return *this;
+
+    return ScreenRect(std::min(left , other.left ), std::min(top   , other.top   ),
+                      std::max(right, other.right), std::max(bottom, other.bottom));
+}
+
+DamageTracker::DamageTracker(size_t width, size_t height):
+    screen_(0, 0, width, height),
+    objects_bounds_(),
+    damage_(),
+    frame_damage_(),
+    full_damage_(true)
+    {}
+
+size_t DamageTracker::add_object()
+{
+    objects_bounds_.emplace_back();
+    return objects_bounds_.size() - 1;
+}
+
+void DamageTracker::report(size_t object_id, const ScreenRect &bounds, bool content_changed)
+{
+    ScreenRect &prev_bounds = objects_bounds_[object_id];
+    if (!content_changed && prev_bounds == bounds)
+        return;
+
+    add_damage(prev_bounds);
+    add_damage(bounds);
+    prev_bounds = bounds;
+}
+
+void DamageTracker::add_damage(const ScreenRect &rect)
+{
+    ScreenRect clipped = rect.intersect(screen_);
+    if (!clipped.is_empty())
+        damage_.push_back(clipped);
+}
+
+void DamageTracker::invalidate()
+{
+    full_damage_ = true;
+}
+
+const std::vector<ScreenRect> &DamageTracker::finish_frame()
+{
+    merge_damage();
+
+    frame_damage_.swap(damage_);
+    damage_.clear();
+    full_damage_ = false;
+
+    return frame_damage_;
+}
+
+const std::vector<ScreenRect> &DamageTracker::get_frame_damage() const
+{
+    return frame_damage_;
+}
+
+ScreenRect DamageTracker::get_screen() const
+{
+    return screen_;
+}
+
+/*
+*   Overlapping rectangles are replaced by their union until no two of them
+*   overlap, so every pixel is repainted at most once.
+*/
+void DamageTracker::merge_damage()
+{
+    if (full_damage_)
+    {
+        damage_.assign(1, screen_);
+        return;
+    }
+
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < damage_.size() && !merged; ++i)
+        {
+            for (size_t j = i + 1; j < damage_.size(); ++j)
+            {
+                if (!damage_[i].is_intersect(damage_[j]))
+                    continue;
+
+                damage_[i] = damage_[i].unite(damage_[j]);
+                damage_[j] = damage_.back();
+                damage_.pop_back();
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    size_t damaged_area = 0;
+    for (const ScreenRect &rect : damage_)
+        damaged_area += rect.get_area();
+
+    if (damaged_area > Max_damage_fraction_ * screen_.get_area())
+        damage_.assign(1, screen_);
+}
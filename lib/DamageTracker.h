@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Rectangle of screen pixels [left, right) x [top, bottom)
+struct ScreenRect final
+{
+    ScreenRect(int left_bound = 0, int top_bound = 0, int right_bound = 0, int bottom_bound = 0);
+
+    int left   = 0;
+    int top    = 0;
+    int right  = 0;
+    int bottom = 0;
+
+    int get_width () const;
+    int get_height() const;
+    size_t get_area() const;
+
+    bool is_empty() const;
+    bool is_intersect(const ScreenRect &other) const;
+
+    ScreenRect intersect(const ScreenRect &other) const;
+    ScreenRect unite(const ScreenRect &other) const;
+
+    bool operator==(const ScreenRect &other) const = default;
+};
+
+/*
+*   Collects the screen areas that have to be repainted in the next frame.
+*   Drawables report their bounds every frame; the old and the new bounds are
+*   damaged whenever the bounds or the content change.
+*/
+class DamageTracker final
+{
+    public:
+        DamageTracker(size_t width, size_t height);
+
+        size_t add_object();
+        void report(size_t object_id, const ScreenRect &bounds, bool content_changed = true);
+
+        void add_damage(const ScreenRect &rect);
+        void invalidate();
+
+        // Merges the collected damage into the frame damage list and starts collecting anew
+        const std::vector<ScreenRect> &finish_frame();
+        const std::vector<ScreenRect> &get_frame_damage() const;
+
+        ScreenRect get_screen() const;
+
+    private:
+        ScreenRect screen_;
+
+        std::vector<ScreenRect> objects_bounds_;
+        std::vector<ScreenRect> damage_;
+        std::vector<ScreenRect> frame_damage_;
+
+        bool full_damage_;
+
+        // Past this share of the screen the whole screen is repainted
+        static constexpr double Max_damage_fraction_ = 0.5;
+
+        void merge_damage();
+};
@@ -0,0 +1,225 @@
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "InputRecording.h"
+
+namespace
+{
+    constexpr char Magic[] = {'L', 'L', 'I', 'R'};
+    constexpr uint64_t Version = 1;
+
+    void write_varint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Small differences of either sign become small numbers
+    uint32_t zigzag_encode(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t zigzag_decode(uint32_t value)
+    {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+}
+
+//----------------------------------------------------------------
+// InputRecorder
+//----------------------------------------------------------------
+
+InputRecorder::InputRecorder():
+    file_(nullptr),
+    prev_dt_bits_(0),
+    events_(),
+    frame_()
+    {}
+
+InputRecorder::~InputRecorder()
+{
+    end();
+}
+
+bool InputRecorder::begin(const char *path, uint32_t seed)
+{
+    end();
+
+    file_ = std::fopen(path, "wb");
+    if (!file_)
+        return false;
+
+    prev_dt_bits_ = 0;
+    events_.clear();
+
+    frame_.assign(std::begin(Magic), std::end(Magic));
+    write_varint(frame_, Version);
+    write_varint(frame_, seed);
+    std::fwrite(frame_.data(), 1, frame_.size(), file_);
+
+    return true;
+}
+
+void InputRecorder::end()
+{
+    if (!file_)
+        return;
+
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool InputRecorder::is_recording() const
+{
+    return file_ != nullptr;
+}
+
+void InputRecorder::add_event(int key, bool is_pressed)
+{
+    if (file_)
+        events_.push_back({key, is_pressed});
+}
+
+// Flushed every frame: it is one small write, and the record survives a crash
+void InputRecorder::record_frame(float dt)
+{
+    if (!file_)
+        return;
+
+    uint32_t dt_bits = std::bit_cast<uint32_t>(dt);
+
+    frame_.clear();
+    write_varint(frame_, zigzag_encode(static_cast<int32_t>(dt_bits - prev_dt_bits_)));
+    write_varint(frame_, events_.size());
+    for (const KeyEvent &event : events_)
+        write_varint(frame_, (static_cast<uint64_t>(event.key) << 1) | event.is_pressed);
+
+    std::fwrite(frame_.data(), 1, frame_.size(), file_);
+    std::fflush(file_);
+
+    prev_dt_bits_ = dt_bits;
+    events_.clear();
+}
+
+//----------------------------------------------------------------
+// InputReplay
+//----------------------------------------------------------------
+
+InputReplay::InputReplay():
+    data_(nullptr),
+    size_(0),
+    position_(0),
+    seed_(0),
+    prev_dt_bits_(0)
+    {}
+
+InputReplay::~InputReplay()
+{
+    close();
+}
+
+bool InputReplay::open(const char *path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(Magic)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    data_ = static_cast<const uint8_t *>(data);
+    size_ = file_stat.st_size;
+    madvise(data, size_, MADV_SEQUENTIAL);
+
+    uint64_t version = 0;
+    uint64_t seed = 0;
+    position_ = sizeof(Magic);
+    if (std::memcmp(data_, Magic, sizeof(Magic)) != 0 || !read_varint(version) || version != Version || !read_varint(seed))
+    {
+        close();
+        return false;
+    }
+
+    seed_ = static_cast<uint32_t>(seed);
+    prev_dt_bits_ = 0;
+    return true;
+}
+
+void InputReplay::close()
+{
+    if (data_)
+        munmap(const_cast<uint8_t *>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+    position_ = 0;
+}
+
+uint32_t InputReplay::get_seed() const
+{
+    return seed_;
+}
+
+bool InputReplay::next_frame(float &dt, std::vector<KeyEvent> &events)
+{
+    size_t frame_start = position_;
+    events.clear();
+
+    uint64_t dt_delta = 0;
+    uint64_t events_count = 0;
+    if (!read_varint(dt_delta) || !read_varint(events_count))
+    {
+        position_ = frame_start;
+        return false;
+    }
+
+    for (uint64_t i = 0; i < events_count; ++i)
+    {
+        uint64_t event = 0;
+        if (!read_varint(event))
+        {
+            position_ = frame_start;
+            events.clear();
+            return false;
+        }
+        events.push_back({static_cast<int>(event >> 1), static_cast<bool>(event & 1)});
+    }
+
+    prev_dt_bits_ += static_cast<uint32_t>(zigzag_decode(static_cast<uint32_t>(dt_delta)));
+    dt = std::bit_cast<float>(prev_dt_bits_);
+    return true;
+}
+
+bool InputReplay::read_varint(uint64_t &value)
+{
+    value = 0;
+    for (unsigned shift = 0; position_ < size_ && shift < 64; shift += 7)
+    {
+        uint8_t byte = data_[position_++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/*
+*   Session record: the seed of std::srand and, for every act(), its dt and
+*   the key presses and releases the game noticed in it. Physics depends on
+*   nothing else, so replaying the record repeats the session bit for bit.
+*
+*   File layout, all numbers are LEB128 varints:
+*       "LLIR" version seed
+*       frame*: zigzag(dt bits - previous dt bits) events_count (key << 1 | pressed)*
+*
+*   Frames are written as they come, so a record of a crashed session is
+*   still readable up to its last complete frame.
+*/
+
+struct KeyEvent final
+{
+    int key;
+    bool is_pressed;
+};
+
+class InputRecorder final
+{
+    public:
+        InputRecorder();
+        ~InputRecorder();
+
+        InputRecorder(const InputRecorder &) = delete;
+        InputRecorder &operator=(const InputRecorder &) = delete;
+
+        // Returns false if the file can't be opened
+        bool begin(const char *path, uint32_t seed);
+        void end();
+
+        bool is_recording() const;
+
+        // Events go into the current frame, record_frame closes it
+        void add_event(int key, bool is_pressed);
+        void record_frame(float dt);
+
+    private:
+        FILE *file_;
+        uint32_t prev_dt_bits_;
+        std::vector<KeyEvent> events_;
+        std::vector<uint8_t> frame_;
+};
+
+class InputReplay final
+{
+    public:
+        InputReplay();
+        ~InputReplay();
+
+        InputReplay(const InputReplay &) = delete;
+        InputReplay &operator=(const InputReplay &) = delete;
+
+        // Maps the file into memory, returns false if it can't be mapped or is not a record
+        bool open(const char *path);
+        void close();
+
+        uint32_t get_seed() const;
+
+        // Reads the next complete frame, returns false at the end of the record
+        bool next_frame(float &dt, std::vector<KeyEvent> &events);
+
+    private:
+        const uint8_t *data_;
+        size_t size_;
+        size_t position_;
+
+        uint32_t seed_;
+        uint32_t prev_dt_bits_;
+
+        bool read_varint(uint64_t &value);
+};
@@ -0,0 +1,65 @@
+#include "LanderEnv.h"
+#include "VectorEnvironment.h"
+
+struct lander_env
+{
+    VectorEnvironment environment;
+};
+
+namespace
+{
+    VectorEnvironment::Buffers to_buffers(const lander_env_buffers *buffers)
+    {
+        return {buffers->states, buffers->frames, buffers->heightmaps, buffers->rewards, buffers->dones};
+    }
+}
+
+lander_env *lander_env_create(const lander_env_config *config)
+{
+    if (!config || config->envs_count == 0 || config->max_steps == 0 || !(config->dt > 0) ||
+        config->world_width  < VectorEnvironment::Min_world_width ||
+        config->world_height < VectorEnvironment::Min_world_height)
+        return nullptr;
+
+    VectorEnvironment::Config env_config = {
+        config->envs_count,
+        config->threads_count ? config->threads_count : WorkStealingPool::get_default_threads_count(),
+        config->seed,
+        config->dt,
+        config->max_steps,
+        config->world_width,
+        config->world_height,
+        config->render_frames != 0,
+        config->heightmap_size
+    };
+
+    // Exceptions must not cross the C interface, running out of memory or threads is just a failure
+    try
+    {
+        return new lander_env{VectorEnvironment(env_config)};
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void lander_env_destroy(lander_env *env)
+{
+    delete env;
+}
+
+size_t lander_env_state_size(void)
+{
+    return VectorEnvironment::State_size;
+}
+
+void lander_env_reset(lander_env *env, const lander_env_buffers *buffers)
+{
+    env->environment.reset(to_buffers(buffers));
+}
+
+void lander_env_step(lander_env *env, const uint32_t *actions, const lander_env_buffers *buffers)
+{
+    env->environment.step(actions, to_buffers(buffers));
+}
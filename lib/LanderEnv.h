@@ -0,0 +1,58 @@
+#ifndef LANDER_ENV_H
+#define LANDER_ENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+*   C interface of VectorEnvironment for training code in other languages
+*   (Python ctypes, for example). The library never allocates observations:
+*   every call writes into the buffers passed by the caller, so they can be
+*   the storage of numpy arrays or tensors. Sizes and meanings of the buffers,
+*   action bits and done values are those of VectorEnvironment.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct lander_env lander_env;
+
+typedef struct lander_env_config
+{
+    size_t   envs_count;
+    size_t   threads_count;  // 0 means all cores
+    uint32_t seed;
+    float    dt;
+    size_t   max_steps;
+
+    size_t   world_width;    // at least 256
+    size_t   world_height;   // at least 256
+
+    int      render_frames;
+    size_t   heightmap_size;
+} lander_env_config;
+
+typedef struct lander_env_buffers
+{
+    float    *states;
+    uint32_t *frames;
+    float    *heightmaps;
+    float    *rewards;
+    uint8_t  *dones;
+} lander_env_buffers;
+
+// Returns null if the config is invalid or the environment can't be created
+lander_env *lander_env_create(const lander_env_config *config);
+void lander_env_destroy(lander_env *env);
+
+size_t lander_env_state_size(void);
+
+void lander_env_reset(lander_env *env, const lander_env_buffers *buffers);
+void lander_env_step(lander_env *env, const uint32_t *actions, const lander_env_buffers *buffers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LANDER_ENV_H
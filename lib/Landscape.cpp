@@ -1,48 +1,101 @@
+#include <algorithm>
+#include <cmath>
+
 #include "Landscape.h"
 
 Landscape::Landscape():
     ground_points_(),
-    prev_point_(ground_points_.end())
+    polylines_(),
+    compiled_(false),
+    points_x_(),
+    points_y_(),
+    slopes_(),
+    segments_(),
+    segment_arrays_(),
+    bvh_(),
+    heights_()
     {}
 
 void Landscape::add_point(uint32_t x, uint32_t y)
 {
     ground_points_[x] = y;
-    if (ground_points_.size() == 1)
-        prev_point_ = ground_points_.begin();
+    compiled_ = false;
 }
 
-uint32_t Landscape::get_height(uint32_t x)
+void Landscape::add_polyline(const std::vector<Vector2d> &points)
 {
-    if (ground_points_.empty())
-        return 0;
+    polylines_.push_back(points);
+    compiled_ = false;
+}
 
-    int64_t cache = try_in_cache(x);
-    if (cache >= 0)
-        return cache;
+void Landscape::compile()
+{
+    size_t points_num = ground_points_.size();
 
-    auto right = ground_points_.lower_bound(x);
-    auto left  = right;
-    if (right == ground_points_.begin())
-        left = ground_points_.end();
-    else
-        --left;
+    points_x_.clear();
+    points_y_.clear();
+    points_x_.reserve(points_num);
+    points_y_.reserve(points_num);
+    for (const auto &[x, y] : ground_points_)
+    {
+        points_x_.push_back(x);
+        points_y_.push_back(y);
+    }
 
-    prev_point_ = left;
-    if (right == ground_points_.end())
+    size_t height_map_segments_num = points_num > 0 ? points_num - 1 : 0;
+    slopes_.resize(height_map_segments_num);
+    segments_.clear();
+    for (size_t i = 0; i < height_map_segments_num; ++i)
     {
-        prev_point_ = left;
-        return (*left).second;
+        slopes_[i] = (static_cast<double>(points_y_[i + 1]) - points_y_[i]) / (points_x_[i + 1] - points_x_[i]);
+        segments_.emplace_back(points_x_[i], points_y_[i], points_x_[i + 1], points_y_[i + 1]);
     }
-    if (left == ground_points_.end())
+
+    for (const auto &polyline : polylines_)
     {
-        prev_point_ = ground_points_.begin();
-        return (*right).second;
+        for (size_t i = 0; i + 1 < polyline.size(); ++i)
+            segments_.emplace_back(polyline[i], polyline[i + 1]);
     }
 
-    const auto &[x_left, y_left] = *left;
-    const auto &[x_right, y_right] = *right;
-    return interpolate(x, x_left, x_right, y_left, y_right);
+    segment_arrays_.clear();
+    for (const Segment &segment : segments_)
+    {
+        double dx = segment.b_x - segment.a_x;
+        double dy = segment.b_y - segment.a_y;
+        double length = std::sqrt(dx * dx + dy * dy);
+
+        // Unit normal pointing away from the solid side
+        Vector2d normal = length > 0 ? Vector2d(dy / length, -dx / length) : Vector2d(0, -1);
+        segment_arrays_.push_back(segment, normal);
+    }
+
+    bvh_.build(segments_);
+
+    heights_.clear();
+    if (points_num > 0)
+    {
+        heights_.resize(points_x_.back() + 1);
+        for (uint32_t x = 0; x < heights_.size(); ++x)
+            heights_[x] = get_height_naive(x);
+    }
+
+    compiled_ = true;
+}
+
+bool Landscape::is_compiled() const
+{
+    return compiled_;
+}
+
+uint32_t Landscape::get_height(uint32_t x) const
+{
+    if (!compiled_)
+        return get_height_naive(x);
+
+    if (heights_.empty())
+        return 0;
+
+    return heights_[std::min<size_t>(x, heights_.size() - 1)];
 }
 
 uint32_t Landscape::get_height_naive(uint32_t x) const
@@ -50,10 +103,6 @@ uint32_t Landscape::get_height_naive(uint32_t x) const
     if (ground_points_.empty())
         return 0;
 
-    int64_t cache = try_in_cache(x);
-    if (cache >= 0)
-        return cache;
-
     auto right = ground_points_.lower_bound(x);
     auto left  = right;
     if (right == ground_points_.begin())
@@ -71,83 +120,140 @@ uint32_t Landscape::get_height_naive(uint32_t x) const
     return interpolate(x, x_left, x_right, y_left, y_right);
 }
 
-bool Landscape::check_collision(const RectCollider &collider, std::vector<CollisionInfo> &info) const
+double Landscape::get_slope(uint32_t x) const
 {
-    info.clear();
+    if (!compiled_ || slopes_.empty())
+        return 0;
 
-    int x_min = collider.get_AABB().left;
-    int x_max = collider.get_AABB().right;
+    size_t right = std::upper_bound(points_x_.begin(), points_x_.end(), x) - points_x_.begin();
+    if (right == 0 || right == points_x_.size())
+        return 0;
 
-    if (x_max < 0)
-        return false;
+    return slopes_[right - 1];
+}
+
+bool Landscape::check_collisions(const std::vector<ShapeCollider> &colliders, std::vector<Contact> &contacts) const
+{
+    contacts.clear();
 
-    auto end_indicator = ground_points_.upper_bound(x_max);
-    if (end_indicator == ground_points_.begin())
+    if (!compiled_)
         return false;
-    if (end_indicator != ground_points_.end())
-        ++end_indicator;
 
-    auto it = ground_points_.begin();
-    auto prev_it = it++;
+    // Scratch space is per thread, so that the query stays safe to call from several threads
+    thread_local Narrowphase narrowphase;
+    thread_local std::vector<uint32_t> candidates;
 
-    if (x_min >= 0)
+    for (uint32_t collider_id = 0; collider_id < colliders.size(); ++collider_id)
     {
-        auto it = ground_points_.lower_bound(x_min);
-        auto prev_it = it;
-        if (it != ground_points_.begin())
-            --prev_it;
-        else
-            ++it;
+        const ShapeCollider &collider = colliders[collider_id];
+
+        candidates.clear();
+        bvh_.query(collider.get_AABB(), candidates);
+        narrowphase.collide(collider_id, collider, segment_arrays_, candidates, contacts);
     }
 
-    bool collision = false;
+    return !contacts.empty();
+}
+
+/*
+*   Conservative advancement by sampling: poses are taken so that no vertex
+*   moves more than half of the collider thickness between two of them,
+*   so consecutive poses overlap and a segment crossing the swept area hits
+*   one of them. The first hit is refined by bisection.
+*/
+double Landscape::get_time_of_impact(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const
+{
+    if (!compiled_)
+        return 1;
 
-    while (it != end_indicator)
+    // The bounding box corners bound the distance of any point of the shape from center
+    const AABB &start_box = collider.get_AABB();
+    double max_dx = std::max(std::abs(start_box.left - center.x), std::abs(start_box.right  - center.x));
+    double max_dy = std::max(std::abs(start_box.top  - center.y), std::abs(start_box.bottom - center.y));
+    double max_radius = std::sqrt(max_dx * max_dx + max_dy * max_dy);
+
+    static constexpr size_t Max_samples = 64;
+    double max_travel = offset.norm() + std::abs(angle) * max_radius;
+    double max_sample_travel = std::max(0.5 * collider.get_thickness(), 1e-3);
+    size_t samples = std::clamp<size_t>(std::ceil(max_travel / max_sample_travel), 1, Max_samples);
+
+    // Candidates for the whole step: segments met by any sampled pose
+    AABB swept_box = start_box;
+    std::vector<ShapeCollider> poses;
+    poses.reserve(samples);
+    for (size_t i = 1; i <= samples; ++i)
     {
-        const auto &[x_1, y_1] = *prev_it;
-        Vector2d first_point(x_1, y_1);
-        const auto &[x_2, y_2] = *it;
-        Vector2d second_point(x_2, y_2);
+        double t = static_cast<double>(i) / samples;
+        poses.push_back(get_moved_collider(collider, center, offset * t, angle * t));
+
+        const AABB &box = poses.back().get_AABB();
+        swept_box.left   = std::min(swept_box.left  , box.left  );
+        swept_box.right  = std::max(swept_box.right , box.right );
+        swept_box.top    = std::max(swept_box.top   , box.top   );
+        swept_box.bottom = std::min(swept_box.bottom, box.bottom);
+    }
 
-        Segment segment(first_point, second_point);
+    std::vector<uint32_t> segment_ids;
+    bvh_.query(swept_box, segment_ids);
+    if (segment_ids.empty())
+        return 1;
 
-        if (collider.check_AABB_segment_collision(segment))
+    if (is_colliding(collider, segment_ids))
+        return 0;
+
+    for (size_t i = 1; i <= samples; ++i)
+    {
+        if (!is_colliding(poses[i - 1], segment_ids))
+            continue;
+
+        double free_t = static_cast<double>(i - 1) / samples;
+        double hit_t  = static_cast<double>(i) / samples;
+        while (hit_t - free_t > Time_of_impact_tolerance)
         {
-            std::pair<bool, Vector2d> mtv_if_collision = collider.check_collision(segment);
-            if (mtv_if_collision.first)
-            {
-                collision = true;
-                Vector2d mtv = mtv_if_collision.second.y > 0 ? -mtv_if_collision.second : mtv_if_collision.second;
-                Vector2d normal = segment.get_normal().normalize();
-                normal = normal.y > 0 ? -normal : normal;
-                info.emplace_back(mtv, normal);
-            }
+            double mid_t = (free_t + hit_t) / 2;
+            if (is_colliding(get_moved_collider(collider, center, offset * mid_t, angle * mid_t), segment_ids))
+                hit_t = mid_t;
+            else
+                free_t = mid_t;
         }
-        ++it;
-        ++prev_it;
+
+        return hit_t;
     }
 
-    return collision;
+    return 1;
 }
 
-void Landscape::clear()
+ShapeCollider Landscape::get_moved_collider(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const
 {
-    ground_points_.clear();
+    ShapeCollider moved = collider;
+
+    double sin = std::sin(angle);
+    double cos = std::cos(angle);
+    Vector2d relative = collider.get_transform().get_position() - center;
+    Vector2d rotated(cos * relative.x - sin * relative.y, sin * relative.x + cos * relative.y);
+
+    moved.rotate(angle);
+    moved.set_position(center + rotated + offset);
+    return moved;
 }
 
-int64_t Landscape::try_in_cache(uint32_t x) const
+bool Landscape::is_colliding(const ShapeCollider &collider, const std::vector<uint32_t> &segment_ids) const
 {
-    const auto &[x_left, y_left] = *prev_point_;
-    if (x_left > x)
-        return -1;
+    for (uint32_t segment_id : segment_ids)
+    {
+        const Segment &segment = segments_[segment_id];
+        if (collider.check_AABB_segment_collision(segment) && collider.check_collision(segment).first)
+            return true;
+    }
 
-    auto next_point = prev_point_;
-    ++next_point;
-    const auto &[x_right, y_right] = *next_point;
-    if (x_right < x)
-        return -1;
+    return false;
+}
 
-    return interpolate(x, x_left, x_right, y_left, y_right);
+void Landscape::clear()
+{
+    ground_points_.clear();
+    polylines_.clear();
+    compiled_ = false;
 }
 
 uint32_t Landscape::interpolate(uint32_t x, uint32_t left, uint32_t right, uint32_t left_height, uint32_t right_height) const
@@ -155,4 +261,4 @@ uint32_t Landscape::interpolate(uint32_t x, uint32_t left, uint32_t right, uint3
     double t = static_cast<double>(right - x) / (right - left);
     // t = -2 * t * t * t + 3 * t * t;
     return left_height * t + right_height * (1 - t);
-}
\ No newline at end of file
+}
@@ -4,7 +4,9 @@
 #include <map>
 #include <vector>
 
-#include "RectCollider.h"
+#include "Narrowphase.h"
+#include "ShapeCollider.h"
+#include "SegmentBVH.h"
 
 class Landscape final
 {
@@ -13,10 +15,43 @@ class Landscape final
 
         void add_point(uint32_t x, uint32_t y);
 
-        uint32_t get_height(uint32_t x);
+        /*
+        *   Extra ground that a height map cannot describe (overhangs, caves).
+        *   Solid lies to the right of the direction of travel on the screen,
+        *   i.e. below a polyline going from left to right. Collisions only.
+        */
+        void add_polyline(const std::vector<Vector2d> &points);
+
+        /*
+        *   Builds the flat representation of the added points: sorted point
+        *   arrays, the segment table with normals, the segment BVH and the
+        *   height of every column. Queries below are const and safe to call
+        *   from several threads after it.
+        */
+        void compile();
+        bool is_compiled() const;
+
+        uint32_t get_height(uint32_t x) const;
         uint32_t get_height_naive(uint32_t x) const;
 
-        bool check_collision(const RectCollider &collider, std::vector<CollisionInfo> &info) const;
+        // Slope dy/dx of the segment under column x, 0 outside the ground
+        double get_slope(uint32_t x) const;
+
+        /*
+        *   Fills contacts with every (collider, segment) overlap, grouped by
+        *   collider in the order of colliders. Returns whether there are any.
+        */
+        bool check_collisions(const std::vector<ShapeCollider> &colliders, std::vector<Contact> &contacts) const;
+
+        /*
+        *   Continuous test for a collider that moves by offset and rotates by
+        *   angle around center during the step. Returns the fraction of the step
+        *   at which it first touches the ground (within Time_of_impact_tolerance),
+        *   1 if it does not touch it at all.
+        */
+        double get_time_of_impact(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const;
+
+        static constexpr double Time_of_impact_tolerance = 1e-3;
 
         void clear();
 
@@ -24,8 +59,25 @@ class Landscape final
         using ground_t = std::map<uint32_t, uint32_t>;
         ground_t ground_points_;
 
-        mutable ground_t::iterator prev_point_;
+        std::vector<std::vector<Vector2d>> polylines_;
+
+        bool compiled_;
+
+        // Height map points, height map segment i goes from point i to point i + 1
+        std::vector<uint32_t> points_x_;
+        std::vector<uint32_t> points_y_;
+        std::vector<double> slopes_;
+
+        // All segments: the height map ones first, then the polylines
+        std::vector<Segment> segments_;
+        SegmentArrays segment_arrays_;
+        SegmentBVH bvh_;
+
+        // Height of every column from 0 to the last point
+        std::vector<uint32_t> heights_;
+
+        ShapeCollider get_moved_collider(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const;
+        bool is_colliding(const ShapeCollider &collider, const std::vector<uint32_t> &segment_ids) const;
 
-        int64_t try_in_cache(uint32_t x) const;
         uint32_t interpolate(uint32_t x, uint32_t left, uint32_t right, uint32_t left_height, uint32_t right_height) const;
-};
\ No newline at end of file
+};
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Color.h"
+#include "Layer.h"
+
+Layer::Layer(size_t width, size_t height, bool opaque):
+    pixels_(),
+    width_(width),
+    height_(height),
+    opaque_(opaque),
+    valid_(false)
+    {}
+
+size_t Layer::get_width() const
+{
+    return width_;
+}
+
+size_t Layer::get_height() const
+{
+    return height_;
+}
+
+bool Layer::is_opaque() const
+{
+    return opaque_;
+}
+
+bool Layer::is_valid() const
+{
+    return valid_;
+}
+
+void Layer::invalidate()
+{
+    valid_ = false;
+}
+
+uint32_t *Layer::begin_paint()
+{
+    // Allocated on the first paint, so layers that are never drawn (e.g. headless runs) cost nothing
+    pixels_.assign(width_ * height_, 0);
+    valid_ = true;
+    return pixels_.data();
+}
+
+void Layer::compose(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip) const
+{
+    ScreenRect target = clip.intersect(ScreenRect(0, 0, std::min(width, width_), std::min(height, height_)));
+    if (target.is_empty() || pixels_.empty())
+        return;
+
+    if (opaque_)
+    {
+        // A full width area is contiguous in both images and goes with a single copy
+        if (width == width_ && target.left == 0 && target.right == static_cast<int>(width))
+        {
+            std::memcpy(buffer + target.top * width, pixels_.data() + target.top * width_,
+                        target.get_area() * sizeof(uint32_t));
+            return;
+        }
+
+        for (int y = target.top; y < target.bottom; ++y)
+            std::memcpy(buffer + y * width + target.left, pixels_.data() + y * width_ + target.left,
+                        target.get_width() * sizeof(uint32_t));
+        return;
+    }
+
+    for (int y = target.top; y < target.bottom; ++y)
+    {
+        const uint32_t *src = pixels_.data() + y * width_;
+        uint32_t *dst = buffer + y * width;
+
+        int x = target.left;
+        while (x < target.right)
+        {
+            while (x < target.right && (src[x] >> 24) == 0)
+                ++x;
+
+            int run_begin = x;
+            while (x < target.right && (src[x] >> 24) != 0)
+                ++x;
+
+            Color::blend_span(dst + run_begin, src + run_begin, x - run_begin);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DamageTracker.h"
+
+/*
+*   Persistent image of rarely changing content. The owner repaints it after
+*   invalidate() and composes it into the frame every frame. An opaque layer is
+*   copied and is meant to start the frame; a transparent one is blended over
+*   what is below it, pixels with zero alpha are skipped, so layers can be stacked.
+*/
+class Layer final
+{
+    public:
+        Layer(size_t width, size_t height, bool opaque = true);
+
+        size_t get_width () const;
+        size_t get_height() const;
+        bool is_opaque() const;
+
+        bool is_valid() const;
+        void invalidate();
+
+        // Clears the layer to zero for repainting and marks it valid
+        uint32_t *begin_paint();
+
+        void compose(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip) const;
+
+    private:
+        std::vector<uint32_t> pixels_;
+        size_t width_;
+        size_t height_;
+        bool opaque_;
+        bool valid_;
+};
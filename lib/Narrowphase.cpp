@@ -0,0 +1,268 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Narrowphase.h"
+
+namespace
+{
+    typedef double  lane_t __attribute__((vector_size(Narrowphase::Lanes_count * sizeof(double))));
+    typedef int64_t mask_t __attribute__((vector_size(Narrowphase::Lanes_count * sizeof(int64_t))));
+
+    lane_t load(const double *src)
+    {
+        lane_t lanes;
+        std::memcpy(&lanes, src, sizeof(lanes));
+        return lanes;
+    }
+
+    lane_t broadcast(double value)
+    {
+        return lane_t{} + value;
+    }
+
+    lane_t min(lane_t lhs, lane_t rhs) { return lhs < rhs ? lhs : rhs; }
+    lane_t max(lane_t lhs, lane_t rhs) { return lhs > rhs ? lhs : rhs; }
+    lane_t abs(lane_t lanes)           { return lanes < 0 ? -lanes : lanes; }
+
+    lane_t sqrt(lane_t lanes)
+    {
+        for (size_t lane = 0; lane < Narrowphase::Lanes_count; ++lane)
+            lanes[lane] = std::sqrt(lanes[lane]);
+        return lanes;
+    }
+
+    bool all(mask_t mask)
+    {
+        for (size_t lane = 0; lane < Narrowphase::Lanes_count; ++lane)
+            if (!mask[lane])
+                return false;
+        return true;
+    }
+
+    // Per lane state of SAT: whether an axis separated the shapes and the axis of the smallest push
+    struct LanesSAT
+    {
+        mask_t separated;
+        lane_t min_translation_abs;
+        lane_t min_translation;
+        lane_t min_axis_x;
+        lane_t min_axis_y;
+
+        LanesSAT():
+            separated(),
+            min_translation_abs(broadcast(std::numeric_limits<double>::infinity())),
+            min_translation(),
+            min_axis_x(),
+            min_axis_y()
+            {}
+
+        // Same rules as SAT_check_one_axis: first is the collider, second is the segment
+        void check_axis(lane_t first_min, lane_t first_max, lane_t second_min, lane_t second_max,
+                        lane_t axis_x, lane_t axis_y, mask_t valid)
+        {
+            mask_t is_separating = (first_min > second_max) | (first_max < second_min);
+            separated |= is_separating & valid;
+
+            lane_t push_back    = first_max - second_min;
+            lane_t push_forward = second_max - first_min;
+            lane_t translation  = push_back < push_forward ? -push_back : push_forward;
+            lane_t translation_abs = abs(translation);
+
+            mask_t is_better = valid & ~is_separating & (translation_abs < min_translation_abs);
+            min_translation_abs = is_better ? translation_abs : min_translation_abs;
+            min_translation     = is_better ? translation     : min_translation;
+            min_axis_x          = is_better ? axis_x          : min_axis_x;
+            min_axis_y          = is_better ? axis_y          : min_axis_y;
+        }
+    };
+
+    constexpr double Min_axis_length_sq = 1e-18;
+}
+
+void SegmentArrays::push_back(const Segment &segment, Vector2d normal)
+{
+    a_x.push_back(segment.a_x);
+    a_y.push_back(segment.a_y);
+    b_x.push_back(segment.b_x);
+    b_y.push_back(segment.b_y);
+    normal_x.push_back(normal.x);
+    normal_y.push_back(normal.y);
+}
+
+void SegmentArrays::clear()
+{
+    a_x.clear();
+    a_y.clear();
+    b_x.clear();
+    b_y.clear();
+    normal_x.clear();
+    normal_y.clear();
+}
+
+size_t SegmentArrays::size() const
+{
+    return a_x.size();
+}
+
+Narrowphase::Narrowphase():
+    batch_(),
+    batch_ids_()
+    {}
+
+void Narrowphase::collide(uint32_t collider_id, const ShapeCollider &collider, const SegmentArrays &segments,
+                          const std::vector<uint32_t> &segment_ids, std::vector<Contact> &contacts)
+{
+    if (segment_ids.empty())
+        return;
+
+    gather(segments, segment_ids);
+    collider.visit([this, collider_id, &contacts](const auto &shape)
+    {
+        collide_polygon(collider_id, shape.get_vertices(), shape.get_radius(), contacts);
+    });
+}
+
+// Copies the candidates into lanes, padding the last ones with degenerate segments
+void Narrowphase::gather(const SegmentArrays &segments, const std::vector<uint32_t> &segment_ids)
+{
+    batch_.clear();
+    batch_ids_.assign(segment_ids.begin(), segment_ids.end());
+
+    for (uint32_t id : segment_ids)
+    {
+        batch_.a_x.push_back(segments.a_x[id]);
+        batch_.a_y.push_back(segments.a_y[id]);
+        batch_.b_x.push_back(segments.b_x[id]);
+        batch_.b_y.push_back(segments.b_y[id]);
+        batch_.normal_x.push_back(segments.normal_x[id]);
+        batch_.normal_y.push_back(segments.normal_y[id]);
+    }
+
+    while (batch_.size() % Lanes_count != 0)
+        batch_.push_back(Segment(0, 0, 0, 0), Vector2d(0, -1));
+}
+
+template<size_t number_of_vertices>
+void Narrowphase::collide_polygon(uint32_t collider_id, const std::array<Vector2d, number_of_vertices> &vertices,
+                                  double radius, std::vector<Contact> &contacts) const
+{
+    // Axes of the collider edges and its projections on them do not depend on the segment
+    constexpr size_t number_of_edges = number_of_vertices < 3 ? number_of_vertices - 1 : number_of_vertices;
+    std::array<Vector2d, number_of_edges> edge_axes;
+    std::array<Vector2d, number_of_edges> edge_projections;
+    std::array<bool, number_of_edges> edge_is_valid;
+    for (size_t edge_id = 0; edge_id < number_of_edges; ++edge_id)
+    {
+        Vector2d axis = (vertices[(edge_id + 1) % number_of_vertices] - vertices[edge_id]).normal();
+        edge_is_valid[edge_id] = axis.norm_sq() >= Min_axis_length_sq;
+        if (edge_is_valid[edge_id])
+            axis.normalize();
+
+        edge_axes[edge_id] = axis;
+        edge_projections[edge_id] = get_min_max_projection_coord(vertices, axis) + Vector2d(-radius, radius);
+    }
+
+    const mask_t all_lanes = ~mask_t{};
+    const size_t batch_size = batch_.size();
+    for (size_t first = 0; first < batch_size; first += Lanes_count)
+    {
+        const lane_t a_x = load(batch_.a_x.data() + first);
+        const lane_t a_y = load(batch_.a_y.data() + first);
+        const lane_t b_x = load(batch_.b_x.data() + first);
+        const lane_t b_y = load(batch_.b_y.data() + first);
+        const lane_t normal_x = load(batch_.normal_x.data() + first);
+        const lane_t normal_y = load(batch_.normal_y.data() + first);
+
+        // Padding lanes start separated so that they do not hold back the early outs
+        const size_t lanes_used = std::min(Lanes_count, batch_ids_.size() - first);
+        LanesSAT sat;
+        for (size_t lane = lanes_used; lane < Lanes_count; ++lane)
+            sat.separated[lane] = ~int64_t{};
+
+        // The segment normal goes first: it separates most colliders hovering above the ground
+        {
+            lane_t first_min = broadcast( std::numeric_limits<double>::infinity());
+            lane_t first_max = broadcast(-std::numeric_limits<double>::infinity());
+            for (const Vector2d &vertex : vertices)
+            {
+                lane_t projection = vertex.x * normal_x + vertex.y * normal_y;
+                first_min = min(first_min, projection);
+                first_max = max(first_max, projection);
+            }
+
+            lane_t projection_a = a_x * normal_x + a_y * normal_y;
+            lane_t projection_b = b_x * normal_x + b_y * normal_y;
+            sat.check_axis(first_min - radius, first_max + radius,
+                           min(projection_a, projection_b), max(projection_a, projection_b),
+                           normal_x, normal_y, all_lanes);
+        }
+        if (all(sat.separated))
+            continue;
+
+        bool all_separated = false;
+        for (size_t edge_id = 0; edge_id < number_of_edges && !all_separated; ++edge_id)
+        {
+            if (!edge_is_valid[edge_id])
+                continue;
+
+            const Vector2d &axis = edge_axes[edge_id];
+            lane_t projection_a = a_x * axis.x + a_y * axis.y;
+            lane_t projection_b = b_x * axis.x + b_y * axis.y;
+            sat.check_axis(broadcast(edge_projections[edge_id].x), broadcast(edge_projections[edge_id].y),
+                           min(projection_a, projection_b), max(projection_a, projection_b),
+                           broadcast(axis.x), broadcast(axis.y), all_lanes);
+            all_separated = all(sat.separated);
+        }
+        if (all_separated)
+            continue;
+
+        // Rounded shapes also need the directions between vertices and segment ends
+        if (radius > 0)
+        {
+            for (const Vector2d &pair_vertex : vertices)
+            {
+                for (int end = 0; end < 2; ++end)
+                {
+                    lane_t axis_x = pair_vertex.x - (end == 0 ? a_x : b_x);
+                    lane_t axis_y = pair_vertex.y - (end == 0 ? a_y : b_y);
+                    lane_t length_sq = axis_x * axis_x + axis_y * axis_y;
+                    mask_t valid = length_sq >= Min_axis_length_sq;
+
+                    lane_t inv_length = 1.0 / sqrt(valid ? length_sq : broadcast(1.0));
+                    axis_x *= inv_length;
+                    axis_y *= inv_length;
+
+                    lane_t first_min = broadcast( std::numeric_limits<double>::infinity());
+                    lane_t first_max = broadcast(-std::numeric_limits<double>::infinity());
+                    for (const Vector2d &vertex : vertices)
+                    {
+                        lane_t projection = vertex.x * axis_x + vertex.y * axis_y;
+                        first_min = min(first_min, projection);
+                        first_max = max(first_max, projection);
+                    }
+
+                    lane_t projection_a = a_x * axis_x + a_y * axis_y;
+                    lane_t projection_b = b_x * axis_x + b_y * axis_y;
+                    sat.check_axis(first_min - radius, first_max + radius,
+                                   min(projection_a, projection_b), max(projection_a, projection_b),
+                                   axis_x, axis_y, valid);
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < lanes_used; ++lane)
+        {
+            if (sat.separated[lane])
+                continue;
+
+            Vector2d normal(normal_x[lane], normal_y[lane]);
+            Vector2d mtv(sat.min_axis_x[lane] * sat.min_translation[lane], sat.min_axis_y[lane] * sat.min_translation[lane]);
+            if (mtv.dot(normal) < 0)
+                mtv = -mtv;
+
+            Segment segment(a_x[lane], a_y[lane], b_x[lane], b_y[lane]);
+            contacts.push_back({collider_id, batch_ids_[first + lane], {mtv, normal}, segment});
+        }
+    }
+}
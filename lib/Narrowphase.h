@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ShapeCollider.h"
+
+struct Contact
+{
+    uint32_t collider_id;
+    uint32_t segment_id;
+    CollisionInfo info;
+    Segment segment;
+};
+
+/*
+*   Segments in structure of arrays form with unit normals pointing to the free side
+*/
+struct SegmentArrays
+{
+    std::vector<double> a_x;
+    std::vector<double> a_y;
+    std::vector<double> b_x;
+    std::vector<double> b_y;
+    std::vector<double> normal_x;
+    std::vector<double> normal_y;
+
+    void push_back(const Segment &segment, Vector2d normal);
+    void clear();
+    size_t size() const;
+};
+
+/*
+*   Batched SAT of colliders against terrain segments. The candidate segments
+*   of a collider are gathered into lanes and every axis is projected for
+*   Lanes_count segments at once with GCC vector extensions. Results match
+*   SAT_check except for exact ties between axes.
+*/
+class Narrowphase final
+{
+    public:
+        Narrowphase();
+
+        /*
+        *   Appends a contact for every segment of segment_ids the collider overlaps.
+        *   The mtv is oriented along the segment normal.
+        */
+        void collide(uint32_t collider_id, const ShapeCollider &collider, const SegmentArrays &segments,
+                     const std::vector<uint32_t> &segment_ids, std::vector<Contact> &contacts);
+
+        // As wide as a native vector register, wider vectors get split into slow scalar code
+#ifdef __AVX__
+        static constexpr size_t Lanes_count = 4;
+#else
+        static constexpr size_t Lanes_count = 2;
+#endif
+
+    private:
+        SegmentArrays batch_;
+        std::vector<uint32_t> batch_ids_;
+
+        void gather(const SegmentArrays &segments, const std::vector<uint32_t> &segment_ids);
+
+        template<size_t number_of_vertices>
+        void collide_polygon(uint32_t collider_id, const std::array<Vector2d, number_of_vertices> &vertices,
+                             double radius, std::vector<Contact> &contacts) const;
+};
@@ -1,16 +1,25 @@
 #include <random>
 
 #include "Planet.h"
+#include "RenderQueue.h"
 
-Planet::Planet(size_t width, size_t height, Color color):
+Planet::Planet(size_t width, size_t height, Color color, uint32_t seed):
     ground_(),
     width_(width),
     height_(height),
-    color_(color)
+    color_(color),
+    background_(width, height),
+    random_(seed)
     {}
 
+void Planet::set_seed(uint32_t seed)
+{
+    random_.seed(seed);
+}
+
 void Planet::generate_landscape(size_t pixels_per_line, uint32_t height_mean, uint32_t height_std)
 {
+    background_.invalidate();
     ground_.clear();
     static constexpr size_t Areas_count = 3;
     static constexpr size_t Min_area_size = 80;
@@ -51,10 +60,14 @@ void Planet::generate_landscape(size_t pixels_per_line, uint32_t height_mean, ui
             ground_.add_point(x, y);
         }
     }
+
+    ground_.compile();
 }
 
 void Planet::generate_stars()
 {
+    background_.invalidate();
+
     size_t x_min = 1;
     size_t x_max = width_ - 2;
     size_t y_min = 1;
@@ -65,6 +78,37 @@ void Planet::generate_stars()
 
 void Planet::draw(uint32_t *buffer, size_t width, size_t height)
 {
+    draw(buffer, width, height, ScreenRect(0, 0, width, height));
+}
+
+// Opaque, so it replaces whatever was in the clip area before
+void Planet::draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip)
+{
+    prepare_background();
+    background_.compose(buffer, width, height, clip);
+}
+
+void Planet::submit(RenderQueue &queue, int z)
+{
+    prepare_background();
+    queue.add_layer(background_, z);
+}
+
+void Planet::prepare_background()
+{
+    if (!background_.is_valid())
+        paint_background();
+}
+
+bool Planet::check_collisions(const std::vector<ShapeCollider> &colliders, std::vector<Contact> &contacts, float dt) const
+{
+    return ground_.check_collisions(colliders, contacts);
+}
+
+void Planet::paint_background()
+{
+    uint32_t *pixels = background_.begin_paint();
+
     for (Vector2d star_pos : stars_)
     {
         for (int y_rel = -1; y_rel <= 1; ++y_rel)
@@ -77,31 +121,33 @@ void Planet::draw(uint32_t *buffer, size_t width, size_t height)
                 size_t x = star_pos.x + x_rel;
                 size_t y = star_pos.y + y_rel;
                 if (x < width_ && y < height_)
-                    buffer[y * width + x] = Color::White;
+                    pixels[y * width_ + x] = Color::White;
             }
         }
     }
 
-    for (size_t x = 0; x < width; ++x)
+    for (size_t x = 0; x < width_; ++x)
     {
-        size_t cur_height = std::min(static_cast<uint32_t>(height), ground_.get_height(x));
-        for (size_t y = height - 1; y > cur_height; --y)
-        {
-            buffer[y * width + x] = color_;
-        }
+        size_t cur_height = std::min(static_cast<uint32_t>(height_), ground_.get_height(x));
+        for (size_t y = height_ - 1; y > cur_height; --y)
+            pixels[y * width_ + x] = color_;
     }
 }
 
-bool Planet::check_collision(const RectCollider &collider, std::vector<CollisionInfo> &info, float dt) const
+double Planet::get_time_of_impact(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const
+{
+    return ground_.get_time_of_impact(collider, center, offset, angle);
+}
+
+uint32_t Planet::get_ground_height(uint32_t x) const
 {
-    return ground_.check_collision(collider, info);
+    return ground_.get_height(x);
 }
 
-int32_t Planet::generate_rand_from_to(int32_t from, int32_t to) const
+int32_t Planet::generate_rand_from_to(int32_t from, int32_t to)
 {
-    ++to;
     if (to <= from)
         return from;
 
-    return rand() % (to - from) + from;
+    return std::uniform_int_distribution<int32_t>(from, to)(random_);
 }
\ No newline at end of file
@@ -1,21 +1,40 @@
 #pragma once
 
-#include <cstdlib>
+#include <cstdint>
+#include <random>
 
 #include "Color.h"
+#include "DamageTracker.h"
 #include "Landscape.h"
+#include "Layer.h"
+
+class RenderQueue;
 
 class Planet final
 {
     public:
-        Planet(size_t width, size_t height, Color color = Color(200, 200, 200));
+        Planet(size_t width, size_t height, Color color = Color(200, 200, 200), uint32_t seed = Default_seed);
+
+        // The same seed gives the same stars and landscape
+        void set_seed(uint32_t seed);
         void generate_landscape(size_t pixels_per_line, uint32_t height_mean, uint32_t height_std);
 
         void generate_stars();
 
         void draw(uint32_t *buffer, size_t width, size_t height);
+        void draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip);
+        void submit(RenderQueue &queue, int z);
+
+        // draw() repaints a stale background itself, call this first to draw from several threads
+        void prepare_background();
 
-        bool check_collision(const RectCollider &collider, std::vector<CollisionInfo> &info, float dt) const;
+        bool check_collisions(const std::vector<ShapeCollider> &colliders, std::vector<Contact> &contacts, float dt) const;
+        double get_time_of_impact(const ShapeCollider &collider, Vector2d center, Vector2d offset, double angle) const;
+
+        // Screen y of the surface at x
+        uint32_t get_ground_height(uint32_t x) const;
+
+        static constexpr uint32_t Default_seed = std::mt19937::default_seed;
 
     private:
         Landscape ground_;
@@ -23,8 +42,14 @@ class Planet final
         size_t height_;
         Color color_;
 
+        // Stars and ground, repainted only after generate_landscape or generate_stars
+        Layer background_;
+        void paint_background();
+
         static constexpr size_t Stars_count = 100;
         std::array<Vector2d, Stars_count> stars_;
 
-        int32_t generate_rand_from_to(int32_t from, int32_t to) const;
+        // Every planet has its own generator, so planets can be generated from several threads
+        std::mt19937 random_;
+        int32_t generate_rand_from_to(int32_t from, int32_t to);
 };
\ No newline at end of file
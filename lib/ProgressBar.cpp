@@ -1,4 +1,7 @@
+#include <algorithm>
+
 #include "ProgressBar.h"
+#include "RenderQueue.h"
 
 ProgressBar::ProgressBar(Sprite icon, Vector2d position, Vector2d size, Color background, Color progress_color, double max_progress):
     background_    (background),
@@ -26,23 +29,49 @@ void ProgressBar::set_max_progress(double max_progress)
 
 void ProgressBar::draw(uint32_t *buffer, size_t width, size_t height)
 {
-    icon_.draw(buffer, width, height);
+    draw(buffer, width, height, ScreenRect(0, 0, width, height));
+}
 
-    size_t y_min = std::max(static_cast<size_t>(position_.y), 0UL);
-    size_t y_max = std::min(static_cast<size_t>(position_.y + size_.y), height);
+void ProgressBar::draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip)
+{
+    icon_.draw(buffer, width, height, clip);
 
-    size_t x_min = std::max(static_cast<size_t>(position_.x), 0UL);
-    size_t x_max = std::min(static_cast<size_t>(position_.x + size_.x), width);
-    size_t x_divider = x_min;
+    ScreenRect bar(position_.x, position_.y, position_.x + size_.x, position_.y + size_.y);
+    int x_divider = bar.left;
     if (progress_ > 0 && max_progress_ > 0)
-        x_divider = (progress_ / max_progress_) * (x_max - x_min) + x_min;
+        x_divider = (progress_ / max_progress_) * bar.get_width() + bar.left;
 
-    for (size_t y = y_min; y < y_max; ++y)
-    {
-        for (size_t x = x_min; x < x_divider; ++x)
-            buffer[y * width + x] = progress_color_;
+    ScreenRect target = bar.intersect(clip).intersect(ScreenRect(0, 0, width, height));
+    if (target.is_empty())
+        return;
 
-        for (size_t x = x_divider; x < x_max; ++x)
-            buffer[y * width + x] = background_;
+    int x_split = std::clamp(x_divider, target.left, target.right);
+
+    for (int y = target.top; y < target.bottom; ++y)
+    {
+        uint32_t *row = buffer + static_cast<size_t>(y) * width;
+        std::fill(row + target.left, row + x_split, progress_color_);
+        std::fill(row + x_split, row + target.right, background_);
     }
-}
\ No newline at end of file
+}
+
+// The same pixels as draw: the icon and the two parts of the bar
+void ProgressBar::submit(RenderQueue &queue, int z) const
+{
+    icon_.submit(queue, z);
+
+    ScreenRect bar(position_.x, position_.y, position_.x + size_.x, position_.y + size_.y);
+    int x_divider = bar.left;
+    if (progress_ > 0 && max_progress_ > 0)
+        x_divider = (progress_ / max_progress_) * bar.get_width() + bar.left;
+
+    int x_split = std::clamp(x_divider, bar.left, bar.right);
+    queue.add_fill(ScreenRect(bar.left, bar.top, x_split, bar.bottom), progress_color_, z);
+    queue.add_fill(ScreenRect(x_split, bar.top, bar.right, bar.bottom), background_, z);
+}
+
+ScreenRect ProgressBar::get_screen_bounds() const
+{
+    ScreenRect bar(position_.x, position_.y, position_.x + size_.x, position_.y + size_.y);
+    return bar.unite(icon_.get_screen_bounds());
+}
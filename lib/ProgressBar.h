@@ -2,6 +2,8 @@
 
 #include "Sprite.h"
 
+class RenderQueue;
+
 class ProgressBar final
 {
     public:
@@ -11,6 +13,10 @@ class ProgressBar final
         void set_max_progress(double max_progress);
 
         void draw(uint32_t *buffer, size_t width, size_t height);
+        void draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip);
+        void submit(RenderQueue &queue, int z) const;
+
+        ScreenRect get_screen_bounds() const;
 
     private:
         Color background_;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 
 #include "RectTexture.h"
@@ -42,46 +43,87 @@ void RectTexture::set_pixel_color(size_t x, size_t y, uint32_t color)
 void RectTexture::draw_circle(Color color, Vector2d center, double radius)
 {
     double radius_sq = radius * radius;
+    auto inside = [&](int x, int y_rel)
+    {
+        int x_rel = x - center.x;
+        return x_rel * x_rel + y_rel * y_rel < radius_sq;
+    };
+
     for (size_t y = 0; y < height_; ++y)
     {
         int y_rel = static_cast<int>(y) - center.y;
-        for (size_t x = 0; x < width_; ++x)
-        {
-            int x_rel = static_cast<int>(x) - center.x;
-            if (x_rel * x_rel + y_rel * y_rel < radius_sq)
-                set_pixel_color(x, y, color.blend(get_pixel_color(x, y)));
-        }
+        if (y_rel * y_rel >= radius_sq)
+            continue;
+
+        // Row span estimate, trimmed with the exact per pixel test
+        double half_chord = std::sqrt(radius_sq - y_rel * y_rel) + 1;
+        int x_first = std::max(0.0, std::floor(center.x - half_chord));
+        int x_last  = std::min(static_cast<double>(width_), std::ceil(center.x + half_chord) + 1);
+        while (x_first < x_last && !inside(x_first, y_rel))
+            ++x_first;
+        while (x_last > x_first && !inside(x_last - 1, y_rel))
+            --x_last;
+
+        if (x_first < x_last)
+            Color::fill_blend_span(&buffer_[y * width_ + x_first], color, x_last - x_first);
     }
 }
 
-#include <iostream>
+/*
+*   Pixel (x, y) belongs to the rectangle if its center, rotated back by angle
+*   around position, lies inside [0, size.x) x [0, size.y).
+*/
 void RectTexture::draw_rect(Color color, Vector2d position, Vector2d size, double angle)
 {
     double sin = std::sin(angle);
     double cos = std::cos(angle);
 
-    for (size_t y = 0; y < size.y; ++y)
+    for (size_t y = 0; y < height_; ++y)
     {
-        for (size_t x = 0; x < size.x; ++x)
-        {
-            size_t x_final = x * cos - y * sin + position.x;
-            size_t y_final = x * sin + y * cos + position.y;
-
-            if (x_final >= width_ || y_final >= height_)
-                continue;
+        double rel_y = y + 0.5 - position.y;
+        double u_row =  cos * (0.5 - position.x) + sin * rel_y;
+        double v_row = -sin * (0.5 - position.x) + cos * rel_y;
 
-            set_pixel_color(x_final, y_final, color.blend(get_pixel_color(x_final, y_final)));
-            if (x_final + 1 < width_)
-                set_pixel_color(x_final + 1, y_final, color.blend(get_pixel_color(x_final, y_final)));
+        auto inside = [&](int x)
+        {
+            double u = u_row + x * cos;
+            double v = v_row - x * sin;
+            return 0 <= u && u < size.x && 0 <= v && v < size.y;
+        };
+
+        double span_begin = 0;
+        double span_end   = width_;
+        clip_span(u_row,  cos, size.x, span_begin, span_end);
+        clip_span(v_row, -sin, size.y, span_begin, span_end);
+
+        int x_first = span_begin;
+        int x_last  = span_end;
+        while (x_first < x_last && !inside(x_first))
+            ++x_first;
+        while (x_last > x_first && !inside(x_last - 1))
+            --x_last;
+
+        if (x_first < x_last)
+            Color::fill_blend_span(&buffer_[y * width_ + x_first], color, x_last - x_first);
+    }
+}
 
-        }
+void RectTexture::clip_span(double start, double step, double length, double &span_begin, double &span_end)
+{
+    if (std::abs(step) < 1e-12)
+    {
+        if (start < 0 || start >= length)
+            span_end = span_begin;
+        return;
     }
-    // size_t y_max = std::min(height_, static_cast<size_t>(size.y));
-    // size_t x_max = std::min(width_, static_cast<size_t>(size.x));
 
-    // for (size_t y = position.y; y < y_max; ++y)
-    //     for (size_t x = position.x; x < x_max; ++x)
-    //         set_pixel_color(x, y, color.blend(get_pixel_color(x, y)));
+    double first = (0      - start) / step;
+    double last  = (length - start) / step;
+    if (first > last)
+        std::swap(first, last);
+
+    span_begin = std::max(span_begin, std::floor(first) - 1);
+    span_end   = std::min(span_end  , std::ceil (last ) + 1);
 }
 
 size_t RectTexture::get_width() const
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "Color.h"
@@ -26,6 +28,13 @@ class RectTexture final
         size_t get_height() const;
         Vector2d get_size() const;
 
+        /*
+        *   Narrows the span [span_begin, span_end) of a row to the x where
+        *   start + x * step may lie in [0, length), widened by one pixel on both
+        *   sides. Callers trim the ends with their exact test.
+        */
+        static void clip_span(double start, double step, double length, double &span_begin, double &span_end);
+
     private:
         std::vector<uint32_t> buffer_;
         size_t width_;
@@ -8,10 +8,8 @@ RectTransform::RectTransform(const Vector2d &size, const Vector2d &pos, const Ve
     size_(size),
     pivot_(pivot),
     angle_(angle),
-    need_cos_update_(true),
-    need_sin_update_(true),
-    sin_angle_(0.0),
-    cos_angle_(0.0)
+    need_matrix_update_(true),
+    matrix_()
     {}
 
 void RectTransform::move(double x, double y)
@@ -21,7 +19,8 @@ void RectTransform::move(double x, double y)
 
 void RectTransform::move(Vector2d offset)
 {
-    pos_ += offset; 
+    pos_ += offset;
+    update_matrix_offset();
 }
 
 void RectTransform::rotate(double angle)
@@ -31,23 +30,25 @@ void RectTransform::rotate(double angle)
     int factor = sign * angle_ / std::numbers::pi;
     angle_ -= sign * (factor + 1) / 2 * 2 * std::numbers::pi;
 
-    need_sin_update_ = true;
-    need_cos_update_ = true;
+    need_matrix_update_ = true;
 }
 
-void RectTransform::set_position(Vector2d position) 
+void RectTransform::set_position(Vector2d position)
 {
-    pos_ = position; 
+    pos_ = position;
+    update_matrix_offset();
 }
 
 void RectTransform::set_angle(double angle)
-{ 
-    angle = angle_; 
+{
+    angle_ = 0.0;
+    rotate(angle);
 }
 
 void RectTransform::set_pivot(Vector2d pivot)
 {
-    pivot_ = pivot; 
+    pivot_ = pivot;
+    need_matrix_update_ = true;
 }
 
 Vector2d RectTransform::get_position() const
@@ -72,33 +73,33 @@ Vector2d RectTransform::get_pivot() const
 
 double RectTransform::get_sin() const
 {
-    if (!need_sin_update_)
-        return sin_angle_;
-
-    sin_angle_ = std::sin(angle_);
-    need_sin_update_ = false;
-
-    return sin_angle_;
+    return get_matrix().column_x.y;
 }
 
 double RectTransform::get_cos() const
 {
-    if (!need_cos_update_)
-        return cos_angle_;
+    return get_matrix().column_x.x;
+}
+
+const Affine2d &RectTransform::get_matrix() const
+{
+    if (need_matrix_update_)
+    {
+        matrix_ = Affine2d::rotation_around(std::sin(angle_), std::cos(angle_), pivot_, pos_);
+        need_matrix_update_ = false;
+    }
 
-    cos_angle_ = std::cos(angle_);
-    need_cos_update_ = false;
+    return matrix_;
+}
 
-    return cos_angle_;
+// A translation keeps the rotation, so the matrix stays valid without new sin and cos
+void RectTransform::update_matrix_offset()
+{
+    if (!need_matrix_update_)
+        matrix_.offset = pos_ - matrix_.apply_linear(pivot_);
 }
 
 Vector2d RectTransform::transform_point(const Vector2d &point) const
 {
-    double relative_x = point.x - pivot_.x;
-    double relative_y = point.y - pivot_.y;
-
-    return Vector2d(
-        get_cos() * relative_x - get_sin() * relative_y + pos_.x,
-        get_sin() * relative_x + get_cos() * relative_y + pos_.y
-    );
+    return get_matrix().apply(point);
 }
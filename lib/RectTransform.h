@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Vector.h"
+#include "Affine.h"
 
 class RectTransform
 {
@@ -24,6 +24,9 @@ class RectTransform
         double get_sin() const;
         double get_cos() const;
 
+        // R(angle) * (point - pivot) + position, rebuilt lazily after a rotation or a new pivot
+        const Affine2d &get_matrix() const;
+
         Vector2d transform_point(const Vector2d &point) const;
 
     private:
@@ -32,9 +35,8 @@ class RectTransform
         Vector2d pivot_;
         double angle_;
 
-        mutable bool need_sin_update_;
-        mutable bool need_cos_update_;
+        mutable bool need_matrix_update_;
+        mutable Affine2d matrix_;
 
-        mutable double sin_angle_;
-        mutable double cos_angle_;
+        void update_matrix_offset();
 };
\ No newline at end of file
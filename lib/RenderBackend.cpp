@@ -0,0 +1,25 @@
+#include <numeric>
+
+#include "RenderBackend.h"
+
+void SerialRenderer::render(const RenderQueue &queue, uint32_t *buffer, const std::vector<ScreenRect> &areas)
+{
+    const std::vector<RenderCommand> &commands = queue.get_commands();
+    command_ids_.resize(commands.size());
+    std::iota(command_ids_.begin(), command_ids_.end(), 0);
+
+    const size_t width  = queue.get_width();
+    const size_t height = queue.get_height();
+    for (const ScreenRect &area : areas)
+    {
+        ScreenRect clip = area.intersect(ScreenRect(0, 0, width, height));
+        if (clip.is_empty())
+            continue;
+
+        for (size_t i = queue.find_first_visible(command_ids_, clip); i < commands.size(); ++i)
+        {
+            if (commands[i].bounds.is_intersect(clip))
+                RenderQueue::execute(commands[i], buffer, width, height, clip);
+        }
+    }
+}
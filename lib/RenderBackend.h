@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RenderQueue.h"
+
+/*
+*   Executes a prepared RenderQueue into a buffer of the size of the queue.
+*   Only the pixels inside areas (for example the damage of the frame) are
+*   drawn. Every backend gives the same pixels as running the commands one
+*   by one, they differ in how the work is cut and scheduled.
+*/
+class RenderBackend
+{
+    public:
+        virtual ~RenderBackend() = default;
+
+        virtual void render(const RenderQueue &queue, uint32_t *buffer, const std::vector<ScreenRect> &areas) = 0;
+};
+
+// Area by area on the calling thread
+class SerialRenderer final : public RenderBackend
+{
+    public:
+        virtual void render(const RenderQueue &queue, uint32_t *buffer, const std::vector<ScreenRect> &areas) override;
+
+    private:
+        std::vector<uint32_t> command_ids_;
+};
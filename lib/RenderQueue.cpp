@@ -0,0 +1,237 @@
+#include <algorithm>
+
+#include "RenderQueue.h"
+
+namespace
+{
+    bool is_inside(const ScreenRect &inner, const ScreenRect &outer)
+    {
+        return inner.intersect(outer) == inner;
+    }
+
+    // Two rects forming one rect together
+    bool can_merge(const ScreenRect &lhs, const ScreenRect &rhs)
+    {
+        return (lhs.top  == rhs.top  && lhs.bottom == rhs.bottom && (lhs.right  == rhs.left || rhs.right  == lhs.left)) ||
+               (lhs.left == rhs.left && lhs.right  == rhs.right  && (lhs.bottom == rhs.top  || rhs.bottom == lhs.top ));
+    }
+}
+
+//----------------------------------------------------------------
+// RenderCommand
+//----------------------------------------------------------------
+
+bool RenderCommand::is_opaque() const
+{
+    switch (type)
+    {
+        case Type::FILL:
+        {
+            return blend_mode == BlendMode::REPLACE;
+        }
+        case Type::LAYER:
+        {
+            return layer->is_opaque() && layer->is_valid();
+        }
+        case Type::SPRITE:
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+const void *RenderCommand::get_texture_handle() const
+{
+    switch (type)
+    {
+        case Type::FILL:
+        {
+            return nullptr;
+        }
+        case Type::LAYER:
+        {
+            return layer;
+        }
+        case Type::SPRITE:
+        {
+            return &sprite->get_texture();
+        }
+    }
+
+    return nullptr;
+}
+
+//----------------------------------------------------------------
+// RenderQueue
+//----------------------------------------------------------------
+
+RenderQueue::RenderQueue(size_t width, size_t height):
+    width_(width),
+    height_(height),
+    commands_()
+    {}
+
+void RenderQueue::clear()
+{
+    commands_.clear();
+}
+
+void RenderQueue::add_fill(const ScreenRect &rect, Color color, int z, RenderCommand::BlendMode blend_mode)
+{
+    RenderCommand command{RenderCommand::Type::FILL, blend_mode, z, rect};
+    command.color = color;
+    add(command);
+}
+
+void RenderQueue::add_layer(const Layer &layer, int z)
+{
+    RenderCommand::BlendMode blend_mode = layer.is_opaque() ? RenderCommand::BlendMode::REPLACE : RenderCommand::BlendMode::ALPHA;
+
+    RenderCommand command{RenderCommand::Type::LAYER, blend_mode, z, ScreenRect(0, 0, layer.get_width(), layer.get_height())};
+    command.layer = &layer;
+    add(command);
+}
+
+// The bounds also build the rotated image of a cached sprite, so backends only read the sprite
+void RenderQueue::add_sprite(const Sprite &sprite, int z)
+{
+    RenderCommand command{RenderCommand::Type::SPRITE, RenderCommand::BlendMode::ALPHA, z, sprite.get_screen_bounds()};
+    command.sprite = &sprite;
+    add(command);
+}
+
+void RenderQueue::prepare(const std::vector<ScreenRect> &areas)
+{
+    std::stable_sort(commands_.begin(), commands_.end(), [](const RenderCommand &lhs, const RenderCommand &rhs)
+    {
+        return lhs.z < rhs.z;
+    });
+
+    cull(areas);
+    merge_fills();
+    group_textures();
+}
+
+const std::vector<RenderCommand> &RenderQueue::get_commands() const
+{
+    return commands_;
+}
+
+size_t RenderQueue::get_width() const
+{
+    return width_;
+}
+
+size_t RenderQueue::get_height() const
+{
+    return height_;
+}
+
+void RenderQueue::execute(const RenderCommand &command, uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip)
+{
+    switch (command.type)
+    {
+        case RenderCommand::Type::FILL:
+        {
+            ScreenRect target = command.bounds.intersect(clip);
+            for (int y = target.top; y < target.bottom; ++y)
+            {
+                uint32_t *row = buffer + static_cast<size_t>(y) * width;
+                if (command.blend_mode == RenderCommand::BlendMode::REPLACE)
+                    std::fill(row + target.left, row + target.right, command.color.get_color());
+                else
+                    Color::fill_blend_span(row + target.left, command.color, target.get_width());
+            }
+            break;
+        }
+        case RenderCommand::Type::LAYER:
+        {
+            command.layer->compose(buffer, width, height, clip);
+            break;
+        }
+        case RenderCommand::Type::SPRITE:
+        {
+            command.sprite->draw(buffer, width, height, clip);
+            break;
+        }
+    }
+}
+
+void RenderQueue::add(RenderCommand command)
+{
+    command.bounds = command.bounds.intersect(ScreenRect(0, 0, width_, height_));
+    if (!command.bounds.is_empty())
+        commands_.push_back(command);
+}
+
+size_t RenderQueue::find_first_visible(const std::vector<uint32_t> &command_ids, const ScreenRect &clip) const
+{
+    for (size_t i = command_ids.size(); i-- > 0;)
+    {
+        const RenderCommand &command = commands_[command_ids[i]];
+        if (command.is_opaque() && is_inside(clip, command.bounds))
+            return i;
+    }
+
+    return 0;
+}
+
+void RenderQueue::cull(const std::vector<ScreenRect> &areas)
+{
+    std::erase_if(commands_, [&areas](const RenderCommand &command)
+    {
+        return std::none_of(areas.begin(), areas.end(), [&command](const ScreenRect &area) { return area.is_intersect(command.bounds); });
+    });
+}
+
+void RenderQueue::merge_fills()
+{
+    size_t merged_count = 0;
+    for (size_t i = 0; i < commands_.size(); ++i)
+    {
+        const RenderCommand &command = commands_[i];
+        if (merged_count > 0)
+        {
+            RenderCommand &last = commands_[merged_count - 1];
+            if (last.type == RenderCommand::Type::FILL && command.type == RenderCommand::Type::FILL &&
+                last.z == command.z && last.blend_mode == command.blend_mode &&
+                last.color.get_color() == command.color.get_color() && can_merge(last.bounds, command.bounds))
+            {
+                last.bounds = last.bounds.unite(command.bounds);
+                continue;
+            }
+        }
+
+        commands_[merged_count++] = command;
+    }
+
+    commands_.resize(merged_count);
+}
+
+// A sprite moves back to the last sprite of its texture in the same z if it does not overlap anything it passes
+void RenderQueue::group_textures()
+{
+    for (size_t i = 1; i < commands_.size(); ++i)
+    {
+        const RenderCommand &command = commands_[i];
+        if (command.type != RenderCommand::Type::SPRITE)
+            continue;
+
+        size_t target = i;
+        for (size_t k = i; k-- > 0 && commands_[k].z == command.z;)
+        {
+            if (commands_[k].get_texture_handle() == command.get_texture_handle())
+            {
+                target = k + 1;
+                break;
+            }
+            if (commands_[k].bounds.is_intersect(command.bounds))
+                break;
+        }
+
+        if (target < i)
+            std::rotate(commands_.begin() + target, commands_.begin() + i, commands_.begin() + i + 1);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Color.h"
+#include "DamageTracker.h"
+#include "Layer.h"
+#include "Sprite.h"
+
+// One drawing operation of a frame, see RenderQueue
+struct RenderCommand final
+{
+    enum class Type
+    {
+        FILL,    // rect of one color
+        LAYER,   // Layer::compose
+        SPRITE   // Sprite::draw, the sprite is the texture and the transform
+    };
+
+    enum class BlendMode
+    {
+        REPLACE,
+        ALPHA
+    };
+
+    Type type;
+    BlendMode blend_mode;
+    int z;
+
+    // Pixels the command may change, already cut to the screen
+    ScreenRect bounds;
+
+    Color color = Color::Black;
+    const Layer *layer = nullptr;
+    const Sprite *sprite = nullptr;
+
+    // Replaces every pixel of its bounds, whatever was drawn below is not seen
+    bool is_opaque() const;
+
+    // Key of the render state, commands with equal keys go well one after another
+    const void *get_texture_handle() const;
+};
+
+/*
+*   Draw commands of a frame. Objects submit commands instead of drawing:
+*   prepare() puts them in z order (submission order within one z), drops
+*   those outside the areas to be drawn, merges neighbouring fills of one
+*   color and moves sprites of one texture together where nothing between
+*   them overlaps. None of it changes a pixel of the result. A RenderBackend
+*   runs the prepared queue and skips, clip by clip, the commands hidden
+*   under opaque ones (find_first_visible).
+*
+*   The queue keeps pointers to layers and sprites, they must live and stay
+*   unchanged until the frame is rendered.
+*/
+class RenderQueue final
+{
+    public:
+        RenderQueue(size_t width, size_t height);
+
+        void clear();
+
+        void add_fill(const ScreenRect &rect, Color color, int z, RenderCommand::BlendMode blend_mode = RenderCommand::BlendMode::REPLACE);
+        void add_layer(const Layer &layer, int z);
+        void add_sprite(const Sprite &sprite, int z);
+
+        void prepare(const std::vector<ScreenRect> &areas);
+
+        const std::vector<RenderCommand> &get_commands() const;
+
+        /*
+        *   Of the commands with command_ids (in queue order) returns the
+        *   position of the last opaque one covering clip: the ones before it
+        *   are not seen there and need not run
+        */
+        size_t find_first_visible(const std::vector<uint32_t> &command_ids, const ScreenRect &clip) const;
+
+        size_t get_width () const;
+        size_t get_height() const;
+
+        // Runs one command with the clip
+        static void execute(const RenderCommand &command, uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip);
+
+    private:
+        size_t width_;
+        size_t height_;
+
+        std::vector<RenderCommand> commands_;
+
+        void add(RenderCommand command);
+
+        void cull(const std::vector<ScreenRect> &areas);
+        void merge_fills();
+        void group_textures();
+};
@@ -1,36 +1,43 @@
 #include <numbers>
 
+#include "RenderQueue.h"
 #include "Rocket.h"
 
-Rocket::Rocket(Vector2d size, bool expand):
+Rocket::Rocket(Vector2d size):
+    transform_(size),
     sprites_(),
     colliders_(),
-    transform_(size)
+    parts_(),
+    root_node_id_(parts_.add_node())
 {
     set_default_configuration(true);
 
     double one_by_sqrt2 = 1.0 / std::sqrt(2);
 
     // Fire of engines (no colliders)
-    auto rocket_fire = draw_rocket_fire();
-    fire_sprite_id_ = setup_part(rocket_fire, Vector2d(rocket_fire.get_width() / 2, 0), Vector2d(), 0, false).first;
+    auto rocket_fire = std::make_shared<const RectTexture>(draw_rocket_fire());
+    fire_sprite_id_ = setup_part(rocket_fire, Vector2d(rocket_fire->get_width() / 2, 0), Vector2d(), 0, false).first;
 
-    // Rocket roof (square rotated on 45 degree)
-    auto rocket_roof = RectTexture(Color::Red, size.x * one_by_sqrt2, size.x * one_by_sqrt2);
-    setup_part(rocket_roof, rocket_roof.get_size() / 2, Vector2d(0, -size.y / 2 + size.x / 4), -std::numbers::pi / 4);
+    // Rocket roof (square rotated on 45 degree). Its lower half is covered by the body,
+    // so the collider is only the visible triangle
+    auto rocket_roof = std::make_shared<const RectTexture>(Color::Red, size.x * one_by_sqrt2, size.x * one_by_sqrt2);
+    Vector2d roof_position(0, -size.y / 2 + size.x / 4);
+    setup_part(rocket_roof, rocket_roof->get_size() / 2, roof_position, -std::numbers::pi / 4, false);
+    add_collider(TriangleCollider({Vector2d(-size.x / 2, 0), Vector2d(0, -size.x / 2), Vector2d(size.x / 2, 0)}),
+                 parts_.add_node(root_node_id_, roof_position));
 
     // Rocket body with area for roof. (size.x / 4) - diagonal of roof square
-    auto rocket_body = draw_rocket_body();
+    auto rocket_body = std::make_shared<const RectTexture>(draw_rocket_body());
     setup_part(rocket_body, size / 2, Vector2d(0, size.x / 4), 0);
 
-    // Rocket landing legs
-    auto rocket_leg = RectTexture(0xff424242, size.x / 8, size.y / 4);
+    // Rocket landing legs, both sprites draw one texture
+    auto rocket_leg = std::make_shared<const RectTexture>(0xff424242, size.x / 8, size.y / 4);
 
-    left_leg_collider_id_  = setup_part(rocket_leg, Vector2d(rocket_leg.get_width() / 2, 0),
+    left_leg_collider_id_  = setup_part(rocket_leg, Vector2d(rocket_leg->get_width() / 2, 0),
                                                     Vector2d(-size.x / 2, size.y / 2),
                                                     std::numbers::pi / 8).second;
 
-    right_leg_collider_id_ = setup_part(rocket_leg, Vector2d(rocket_leg.get_width() / 2, 0),
+    right_leg_collider_id_ = setup_part(rocket_leg, Vector2d(rocket_leg->get_width() / 2, 0),
                                                     Vector2d( size.x / 2, size.y / 2),
                                                     -std::numbers::pi / 8).second;
 }
@@ -38,7 +45,7 @@ Rocket::Rocket(Vector2d size, bool expand):
 void Rocket::set_default_configuration(bool first_time)
 {
     if (!first_time)
-        sprites_relative_positions_[fire_sprite_id_] += Vector2d(0, -thrust_ / max_thrust_ * transform_.get_size().y / 2);
+        parts_.move(sprites_nodes_[fire_sprite_id_], Vector2d(0, -thrust_ / max_thrust_ * transform_.get_size().y / 2));
 
     mass_                         = 1;
     max_rotation_thrust_          = 1;
@@ -69,6 +76,8 @@ void Rocket::set_default_configuration(bool first_time)
 
     left_leg_landed  = false;
     right_leg_landed = false;
+
+    contact_solver_.clear();
 }
 
 void Rocket::update(double dt)
@@ -77,7 +86,9 @@ void Rocket::update(double dt)
     update_rotation_accel_();
     update_thrust(dt);
 
-    sprites_relative_positions_[fire_sprite_id_] += Vector2d(0, (thrust_ - old_thrust) / max_thrust_ * transform_.get_size().y / 2);
+    if (thrust_ != old_thrust)
+        parts_.move(sprites_nodes_[fire_sprite_id_], Vector2d(0, (thrust_ - old_thrust) / max_thrust_ * transform_.get_size().y / 2));
+
     Vector2d direction(transform_.get_sin(), -transform_.get_cos());
     acceleration_ = free_fall_accel_ + thrust_ * direction / (mass_ + fuel_);
 
@@ -94,6 +105,35 @@ void Rocket::update(double dt)
         state_ = RocketState::LANDED;
 }
 
+Rocket::Snapshot Rocket::get_snapshot() const
+{
+    return {get_position(), get_angle(), velocity_, rotation_speed_, fuel_, hydrazine_, thrust_,
+            engine_mode_, rcs_mode_, prev_passive_mode_, state_, left_leg_landed, right_leg_landed};
+}
+
+// Contacts of the previous steps are forgotten, they are found again in the next step
+void Rocket::restore(const Snapshot &snapshot)
+{
+    parts_.move(sprites_nodes_[fire_sprite_id_], Vector2d(0, (snapshot.thrust - thrust_) / max_thrust_ * transform_.get_size().y / 2));
+
+    set_angle(snapshot.angle);
+    set_position(snapshot.position);
+
+    velocity_          = snapshot.velocity;
+    rotation_speed_    = snapshot.rotation_speed;
+    fuel_              = snapshot.fuel;
+    hydrazine_         = snapshot.hydrazine;
+    thrust_            = snapshot.thrust;
+    engine_mode_       = snapshot.engine_mode;
+    rcs_mode_          = snapshot.rcs_mode;
+    prev_passive_mode_ = snapshot.prev_passive_mode;
+    state_             = snapshot.state;
+    left_leg_landed    = snapshot.left_leg_landed;
+    right_leg_landed   = snapshot.right_leg_landed;
+
+    contact_solver_.clear();
+}
+
 /*
 *   Static preferences of the rocket (getters/setters)
 */
@@ -124,6 +164,20 @@ double Rocket::get_fuel              () const { return fuel_;      }
 
 double Rocket::get_hydrazine         () const { return hydrazine_; }
 
+Vector2d Rocket::get_position        () const { return transform_.get_position(); }
+
+Vector2d Rocket::get_velocity        () const { return velocity_;       }
+
+double Rocket::get_angle             () const { return transform_.get_angle(); }
+
+double Rocket::get_rotation_speed    () const { return rotation_speed_; }
+
+double Rocket::get_thrust            () const { return thrust_; }
+
+Rocket::EngineMode Rocket::get_engine_mode() const { return engine_mode_; }
+
+Rocket::RcsEngineMode Rocket::get_rcs_mode() const { return rcs_mode_; }
+
 /*
 *   Methods for rocket control
 */
@@ -165,91 +219,54 @@ void Rocket::switch_rcs_stabilization_mode()
     }
 }
 
-void Rocket::apply_collision_response(size_t collider_id, const CollisionInfo &info, float dt, size_t number_of_collisions)
+void Rocket::resolve_contacts(const std::vector<Contact> &contacts, float dt)
 {
-    if (velocity_.norm_sq() > Min_speed_norm_sq_to_destroy)
-    {
-        state_ = RocketState::CRASHED;
-        return;
-    }
-    static constexpr double Min_mtv_norm_sq_to_react = 1e-15;
-
-    Vector2d mtv = info.mtv / number_of_collisions;
-    const Vector2d &normal = info.normal;
-
-    if (std::abs(normal.x) > Cos_max_inclination_angle_to_landing)
+    if (!contacts.empty() && velocity_.norm_sq() > Min_speed_norm_sq_to_destroy)
     {
         state_ = RocketState::CRASHED;
         return;
     }
 
-    if (collider_id == left_leg_collider_id_)
-        left_leg_landed = true;
-    if (collider_id == right_leg_collider_id_)
-        right_leg_landed = true;
-
-    if (mtv.norm_sq() < Min_mtv_norm_sq_to_react)
-            return;
-
-    move(mtv / number_of_collisions);
-
-    const RectCollider &collider = colliders_[collider_id];
-    Vector2d collider_position = colliders_relative_positions_[collider_id];
-
-    const auto &vertices = collider.get_vertices();
-    Vector2d most_remote_point = vertices[0];
-    double dot_in_cache = most_remote_point.dot(normal);
-
-    for (size_t i = 1; i < RectCollider::Number_of_vertices; ++i)
+    for (const Contact &contact : contacts)
     {
-        double cur_dot = vertices[i].dot(normal);
-        if (cur_dot < dot_in_cache)
+        if (std::abs(contact.info.normal.x) > Cos_max_inclination_angle_to_landing)
         {
-            most_remote_point = vertices[i];
-            dot_in_cache = cur_dot;
+            state_ = RocketState::CRASHED;
+            return;
         }
-    }
-
-    Vector2d dir_to_center = transform_.get_position() - most_remote_point;
-    double distance_to_center = dir_to_center.norm();
-    dir_to_center /= distance_to_center;
 
-    Vector2d delta_v = -velocity_.dot(mtv) * mtv / mtv.norm_sq();
+        if (contact.collider_id == left_leg_collider_id_)
+            left_leg_landed = true;
+        if (contact.collider_id == right_leg_collider_id_)
+            right_leg_landed = true;
+    }
 
-    if (delta_v.dot(mtv) < 0)
+    contact_solver_.update_manifold(colliders_, contacts);
+    if (contact_solver_.get_points_count() == 0)
         return;
 
-    const auto &rect_size = collider.get_transform().get_size();
-
-    velocity_ += delta_v;
-    Vector2d horizontal_velocity = velocity_.dot(normal.normal()) * normal.normal();
-
-    static constexpr double friction_factor = 0.5;
-    velocity_ -= horizontal_velocity * friction_factor;
+    // The rocket is treated as a uniform box of its size
+    double mass = mass_ + fuel_;
+    Vector2d size = transform_.get_size();
+    double inertia = mass * size.norm_sq() / 12;
 
-    acceleration_ -= acceleration_.dot(mtv) * mtv / mtv.norm_sq();
+    BodyState body{transform_.get_position(), velocity_, rotation_speed_, 1 / mass, 1 / inertia};
+    Vector2d translation = contact_solver_.solve(body);
 
-    // Some physics
-    static constexpr int Inertia_factor = 3;
-    Vector2d rel_pos = most_remote_point - transform_.get_position();
-    double delta_rot_speed = -Inertia_factor * rel_pos.dot((delta_v - horizontal_velocity * friction_factor).normal());
-    delta_rot_speed /= rect_size.norm_sq() + Inertia_factor * (collider_position.norm_sq() + rel_pos.norm_sq());
-    delta_rot_speed /= number_of_collisions;
+    velocity_ = body.velocity;
+    rotation_speed_ = body.angular_velocity;
+    move(translation);
+}
 
-    rotation_speed_ += delta_rot_speed;
+bool Rocket::has_contacts() const
+{
+    return contact_solver_.get_points_count() > 0;
 }
 
 void Rocket::move(double x, double y)
 {
-    size_t sprites_num = std::min(sprites_.size(), sprites_relative_positions_.size());
-    for (size_t i = 0; i < sprites_num; ++i)
-        sprites_[i].set_position(transform_.transform_point(sprites_relative_positions_[i]));
-
-    size_t colliders_num = std::min(colliders_.size(), colliders_relative_positions_.size());
-    for (size_t i = 0; i < colliders_num; ++i)
-        colliders_[i].set_position(transform_.transform_point(colliders_relative_positions_[i]));
-
     transform_.move(x, y);
+    parts_.set_local_position(root_node_id_, transform_.get_position());
 }
 
 void Rocket::move(Vector2d offset)
@@ -259,21 +276,8 @@ void Rocket::move(Vector2d offset)
 
 void Rocket::rotate(double angle)
 {
-    size_t sprites_num = std::min(sprites_.size(), sprites_relative_positions_.size());
-    for (size_t i = 0; i < sprites_num; ++i)
-    {
-        sprites_[i].rotate(angle);
-        sprites_[i].set_position(transform_.transform_point(sprites_relative_positions_[i]));
-    }
-
-    size_t colliders_num = std::min(colliders_.size(), colliders_relative_positions_.size());
-    for (size_t i = 0; i < colliders_num; ++i)
-    {
-        colliders_[i].rotate(angle);
-        colliders_[i].set_position(transform_.transform_point(colliders_relative_positions_[i]));
-    }
-
     transform_.rotate(angle);
+    parts_.set_local_angle(root_node_id_, transform_.get_angle());
 }
 
 void Rocket::set_position(Vector2d position)
@@ -291,15 +295,40 @@ void Rocket::set_angle(double angle)
     rotate(angle - transform_.get_angle());
 }
 
-const std::vector<RectCollider> &Rocket::get_colliders() const
+const std::vector<ShapeCollider> &Rocket::get_colliders() const
 {
+    update_parts();
     return colliders_;
 }
 
 void Rocket::draw(uint32_t *buffer, size_t width, size_t height)
 {
+    draw(buffer, width, height, ScreenRect(0, 0, width, height));
+}
+
+void Rocket::draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip)
+{
+    update_parts();
+    for (const auto &sprite : sprites_)
+        sprite.draw(buffer, width, height, clip);
+}
+
+void Rocket::submit(RenderQueue &queue, int z) const
+{
+    update_parts();
+    for (const auto &sprite : sprites_)
+        sprite.submit(queue, z);
+}
+
+ScreenRect Rocket::get_screen_bounds() const
+{
+    update_parts();
+
+    ScreenRect bounds;
     for (const auto &sprite : sprites_)
-        sprite.draw(buffer, width, height);
+        bounds = bounds.unite(sprite.get_screen_bounds());
+
+    return bounds;
 }
 
 void Rocket::update_thrust(double dt)
@@ -378,26 +407,56 @@ void Rocket::update_rotation_accel_()
     }
 }
 
-std::pair<size_t, size_t> Rocket::setup_part(RectTexture texture, Vector2d center, 
+std::pair<size_t, size_t> Rocket::setup_part(std::shared_ptr<const RectTexture> texture, Vector2d center, 
                                              Vector2d relative_position, double angle, bool need_collider)
 {
-    Vector2d size = Vector2d(texture.get_width(), texture.get_height());
-    Sprite sprite(texture);
+    Vector2d size = Vector2d(texture->get_width(), texture->get_height());
+    size_t node_id = parts_.add_node(root_node_id_, relative_position, angle);
+
+    Sprite sprite(std::move(texture));
     sprite.set_center(center.x, center.y);
-    sprite.rotate(angle);
+    sprite.enable_rotation_cache();
     sprites_.push_back(sprite);
-    sprites_relative_positions_.push_back(relative_position);
+    sprites_nodes_.push_back(node_id);
 
     if (need_collider)
+        add_collider(RectCollider(size, Vector2d(), center), node_id);
+
+    return {sprites_nodes_.size() - 1, colliders_nodes_.size() - 1};
+}
+
+size_t Rocket::add_collider(ShapeCollider collider, size_t node_id)
+{
+    colliders_.push_back(std::move(collider));
+    colliders_nodes_.push_back(node_id);
+
+    return colliders_nodes_.size() - 1;
+}
+
+// World transforms are resolved here, once for all the moves since the last call
+void Rocket::update_parts() const
+{
+    if (!parts_.is_dirty())
+        return;
+
+    parts_.update();
+
+    for (size_t i = 0; i < sprites_.size(); ++i)
     {
-        RectCollider collider(size);
-        collider.set_pivot(center);
-        collider.rotate(angle);
-        colliders_.push_back(collider);
-        colliders_relative_positions_.push_back(relative_position);
+        size_t node_id = sprites_nodes_[i];
+        if (!parts_.is_changed(node_id))
+            continue;
+
+        sprites_[i].set_position(parts_.get_world_position(node_id));
+        sprites_[i].set_angle(parts_.get_world_angle(node_id));
     }
 
-    return {sprites_relative_positions_.size() - 1, colliders_relative_positions_.size() - 1};
+    for (size_t i = 0; i < colliders_.size(); ++i)
+    {
+        size_t node_id = colliders_nodes_[i];
+        if (parts_.is_changed(node_id))
+            colliders_[i].set_transform(parts_.get_world_position(node_id), parts_.get_world_angle(node_id));
+    }
 }
 
 RectTexture Rocket::draw_rocket_body()
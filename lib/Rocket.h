@@ -1,14 +1,17 @@
 #pragma once
 
 #include <cmath>
+#include <memory>
 
-#include "RectCollider.h"
+#include "ContactSolver.h"
+#include "ShapeCollider.h"
 #include "Sprite.h"
+#include "TransformTree.h"
 
 class Rocket final
 {
     public:
-        Rocket(Vector2d size, bool expand = true);
+        Rocket(Vector2d size);
 
         void set_default_configuration(bool first_time = false);
 
@@ -38,9 +41,30 @@ class Rocket final
             CRASHED
         };
 
+        // Flight state of the rocket, enough to continue the flight in another rocket of the same configuration
+        struct Snapshot
+        {
+            Vector2d position;
+            double angle;
+            Vector2d velocity;
+            double rotation_speed;
+            double fuel;
+            double hydrazine;
+            double thrust;
+            EngineMode engine_mode;
+            RcsEngineMode rcs_mode;
+            RcsEngineMode prev_passive_mode;
+            RocketState state;
+            bool left_leg_landed;
+            bool right_leg_landed;
+        };
+
     public:
         void update(double dt);
 
+        Snapshot get_snapshot() const;
+        void restore(const Snapshot &snapshot);
+
         /*
         *   Static preferences of the rocket (getters/setters)
         */
@@ -65,6 +89,13 @@ class Rocket final
         RocketState get_state() const;
         double get_fuel() const;
         double get_hydrazine() const;
+        Vector2d get_position() const;
+        Vector2d get_velocity() const;
+        double get_angle() const;
+        double get_rotation_speed() const;
+        double get_thrust() const;
+        EngineMode get_engine_mode() const;
+        RcsEngineMode get_rcs_mode() const;
 
         /*
         *   Methods for rocket control
@@ -77,7 +108,8 @@ class Rocket final
         *   Some methods to impact the rocket transformation without
         *   using engine (for collisions etc.)
         */
-        void apply_collision_response(size_t collider_id, const CollisionInfo &info, float dt, size_t number_of_collisions);
+        void resolve_contacts(const std::vector<Contact> &contacts, float dt);
+        bool has_contacts() const;
 
         void move(double x, double y);
         void move(Vector2d offset);
@@ -86,12 +118,16 @@ class Rocket final
         void set_position(double x, double y);
         void set_angle(double angle);
 
-        const std::vector<RectCollider> &get_colliders() const;
+        const std::vector<ShapeCollider> &get_colliders() const;
 
         /*
         *   Other
         */
         void draw(uint32_t *buffer, size_t width, size_t height);
+        void draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip);
+        void submit(RenderQueue &queue, int z) const;
+
+        ScreenRect get_screen_bounds() const;
 
     private:
         /*
@@ -129,16 +165,27 @@ class Rocket final
         void update_thrust(double dt);
         void update_rotation_accel_();
 
-        std::vector<Sprite> sprites_;
-        std::vector<Vector2d> sprites_relative_positions_;
-        std::vector<RectCollider> colliders_;
-        std::vector<Vector2d> colliders_relative_positions_;
+        /*
+        *   Parts hang off the root node of parts_ (the rocket transform). Their
+        *   sprites and colliders are updated lazily from the changed nodes.
+        */
+        mutable std::vector<Sprite> sprites_;
+        std::vector<size_t> sprites_nodes_;
+        mutable std::vector<ShapeCollider> colliders_;
+        std::vector<size_t> colliders_nodes_;
 
-        std::pair<size_t, size_t> setup_part(RectTexture texture, Vector2d center,
+        mutable TransformTree parts_;
+        size_t root_node_id_;
+
+        std::pair<size_t, size_t> setup_part(std::shared_ptr<const RectTexture> texture, Vector2d center,
                                              Vector2d relative_position, double angle, bool need_collider = true);
+        size_t add_collider(ShapeCollider collider, size_t node_id);
+        void update_parts() const;
 
         RocketState state_;
 
+        ContactSolver contact_solver_;
+
         static constexpr double Min_speed_norm_sq_to_destroy = 200;
         static constexpr double Max_inclination_angle_to_landing = 30;
         static constexpr double Cos_max_inclination_angle_to_landing = std::cos(Max_inclination_angle_to_landing);
@@ -0,0 +1,288 @@
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#include "RocketEnsemble.h"
+
+namespace
+{
+    typedef double  lane_t __attribute__((vector_size(RocketEnsemble::Lanes_count * sizeof(double))));
+    typedef int64_t mask_t __attribute__((vector_size(RocketEnsemble::Lanes_count * sizeof(int64_t))));
+
+    template<typename Lanes, typename T>
+    Lanes load(const std::vector<T> &array, size_t first)
+    {
+        Lanes lanes;
+        std::memcpy(&lanes, array.data() + first, sizeof(lanes));
+        return lanes;
+    }
+
+    template<typename Lanes, typename T>
+    void store(std::vector<T> &array, size_t first, Lanes lanes)
+    {
+        std::memcpy(array.data() + first, &lanes, sizeof(lanes));
+    }
+
+    lane_t broadcast(double value)
+    {
+        return lane_t{} + value;
+    }
+
+    mask_t broadcast_mode(int64_t mode)
+    {
+        return mask_t{} + mode;
+    }
+
+    // Same results as std::min and std::max, including which argument wins a tie
+    lane_t min(lane_t lhs, lane_t rhs) { return rhs < lhs ? rhs : lhs; }
+    lane_t max(lane_t lhs, lane_t rhs) { return lhs < rhs ? rhs : lhs; }
+    lane_t abs(lane_t lanes)           { return lanes < 0 ? -lanes : lanes; }
+
+    template<typename Mode>
+    mask_t is_mode(mask_t modes, Mode mode)
+    {
+        return modes == broadcast_mode(static_cast<int64_t>(mode));
+    }
+}
+
+RocketEnsemble::RocketEnsemble():
+    RocketEnsemble(Parameters())
+    {}
+
+RocketEnsemble::RocketEnsemble(const Parameters &parameters):
+    parameters_(parameters),
+    count_(0),
+    position_x_(),
+    position_y_(),
+    velocity_x_(),
+    velocity_y_(),
+    angle_(),
+    rotation_speed_(),
+    thrust_(),
+    fuel_(),
+    hydrazine_(),
+    engine_mode_(),
+    rcs_mode_(),
+    prev_passive_mode_(),
+    sin_angle_(),
+    cos_angle_()
+    {}
+
+size_t RocketEnsemble::add(Vector2d position)
+{
+    size_t lander_id = count_++;
+    if (count_ > position_x_.size())
+        resize_arrays(position_x_.size() + Lanes_count);
+
+    reset(lander_id, position);
+    return lander_id;
+}
+
+void RocketEnsemble::reset(size_t lander_id, Vector2d position)
+{
+    position_x_    [lander_id] = position.x;
+    position_y_    [lander_id] = position.y;
+    velocity_x_    [lander_id] = 0;
+    velocity_y_    [lander_id] = 0;
+    angle_         [lander_id] = 0;
+    rotation_speed_[lander_id] = 0;
+    thrust_        [lander_id] = 0;
+    fuel_          [lander_id] = parameters_.max_fuel;
+    hydrazine_     [lander_id] = parameters_.max_hydrazine;
+
+    engine_mode_      [lander_id] = static_cast<int64_t>(Rocket::EngineMode::IDLE);
+    rcs_mode_         [lander_id] = static_cast<int64_t>(Rocket::RcsEngineMode::IDLE);
+    prev_passive_mode_[lander_id] = static_cast<int64_t>(Rocket::RcsEngineMode::IDLE);
+}
+
+void RocketEnsemble::clear()
+{
+    count_ = 0;
+    resize_arrays(0);
+}
+
+size_t RocketEnsemble::get_count() const
+{
+    return count_;
+}
+
+const RocketEnsemble::Parameters &RocketEnsemble::get_parameters() const
+{
+    return parameters_;
+}
+
+/*
+*   Rocket::update for every lane. The branches of the scalar code become
+*   selects and every expression keeps the order of operations of Rocket
+*   (Vector2d divides through a multiplication by the inverse, the angle is
+*   wrapped as in RectTransform::rotate), so the results match it exactly.
+*/
+void RocketEnsemble::update(double dt)
+{
+    const size_t size = position_x_.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        sin_angle_[i] = std::sin(angle_[i]);
+        cos_angle_[i] = std::cos(angle_[i]);
+    }
+
+    const Parameters &params = parameters_;
+    const lane_t zero = broadcast(0.0);
+    const lane_t pi   = broadcast(std::numbers::pi);
+    const lane_t max_thrust = broadcast(params.max_thrust);
+    const lane_t threshold  = broadcast(params.treshold_speed_for_stabilize);
+
+    for (size_t first = 0; first < size; first += Lanes_count)
+    {
+        lane_t fuel           = load<lane_t>(fuel_          , first);
+        lane_t hydrazine      = load<lane_t>(hydrazine_     , first);
+        lane_t thrust         = load<lane_t>(thrust_        , first);
+        lane_t rotation_speed = load<lane_t>(rotation_speed_, first);
+        mask_t engine_mode    = load<mask_t>(engine_mode_   , first);
+        mask_t rcs_mode       = load<mask_t>(rcs_mode_      , first);
+
+        // update_rotation_accel_
+        lane_t mass = params.mass + fuel;
+        lane_t rotation_accel_abs = params.max_rotation_thrust / mass;
+        lane_t stabilize_accel = rotation_speed > threshold ? -rotation_accel_abs :
+                                 rotation_speed < -threshold ? rotation_accel_abs : zero;
+
+        lane_t rotation_accel = is_mode(rcs_mode, Rocket::RcsEngineMode::CCW)       ? -rotation_accel_abs :
+                                is_mode(rcs_mode, Rocket::RcsEngineMode::CW)        ?  rotation_accel_abs :
+                                is_mode(rcs_mode, Rocket::RcsEngineMode::STABILIZE) ?  stabilize_accel    : zero;
+        rotation_accel = hydrazine <= 0 ? zero : rotation_accel;
+
+        // update_thrust
+        lane_t increased_thrust = min(thrust + params.delta_thrust * dt, max_thrust);
+        lane_t decreased_thrust = max(thrust - params.delta_thrust * dt, zero);
+        thrust = is_mode(engine_mode, Rocket::EngineMode::SET_MAX_THRUST)  ? max_thrust       :
+                 is_mode(engine_mode, Rocket::EngineMode::SET_NO_THRUST)   ? zero             :
+                 is_mode(engine_mode, Rocket::EngineMode::INCREASE_THRUST) ? increased_thrust :
+                 is_mode(engine_mode, Rocket::EngineMode::DECREASE_THRUST) ? decreased_thrust : thrust;
+        thrust = fuel <= 0 ? zero : thrust;
+
+        // Acceleration along the direction of the rocket, (sin, -cos)
+        lane_t inverse_mass = 1 / mass;
+        lane_t sin = load<lane_t>(sin_angle_, first);
+        lane_t cos = load<lane_t>(cos_angle_, first);
+        lane_t acceleration_x = params.free_fall_accel.x + ( sin * thrust) * inverse_mass;
+        lane_t acceleration_y = params.free_fall_accel.y + (-cos * thrust) * inverse_mass;
+
+        fuel -= thrust * dt * params.fuel_per_thrust;
+        hydrazine -= abs(rotation_accel) * (params.mass + fuel) * dt * params.hydrazine_per_thrust;
+
+        lane_t velocity_x = load<lane_t>(velocity_x_, first);
+        lane_t velocity_y = load<lane_t>(velocity_y_, first);
+        store(position_x_, first, load<lane_t>(position_x_, first) + velocity_x * dt);
+        store(position_y_, first, load<lane_t>(position_y_, first) + velocity_y * dt);
+        store(velocity_x_, first, velocity_x + acceleration_x * dt);
+        store(velocity_y_, first, velocity_y + acceleration_y * dt);
+
+        // RectTransform::rotate keeps the angle in [-pi, pi]
+        lane_t angle = load<lane_t>(angle_, first) + rotation_speed * dt;
+        lane_t sign = angle >= 0 ? broadcast(1.0) : broadcast(-1.0);
+        mask_t sign_int = __builtin_convertvector(sign, mask_t);
+        mask_t factor   = __builtin_convertvector(sign * angle / pi, mask_t);
+        mask_t turns    = sign_int * (factor + 1) / 2 * 2;
+        angle -= __builtin_convertvector(turns, lane_t) * pi;
+
+        store(angle_, first, angle);
+        store(rotation_speed_, first, rotation_speed + rotation_accel * dt);
+        store(thrust_, first, thrust);
+        store(fuel_, first, fuel);
+        store(hydrazine_, first, hydrazine);
+    }
+}
+
+void RocketEnsemble::toggle_engine(size_t lander_id, Rocket::EngineMode mode)
+{
+    engine_mode_[lander_id] = static_cast<int64_t>(mode);
+}
+
+void RocketEnsemble::toggle_rcs(size_t lander_id, Rocket::RcsEngineMode mode)
+{
+    switch (mode)
+    {
+        case Rocket::RcsEngineMode::PREV_PASSIVE_MODE:
+        {
+            rcs_mode_[lander_id] = prev_passive_mode_[lander_id];
+            return;
+        }
+        case Rocket::RcsEngineMode::IDLE:
+        case Rocket::RcsEngineMode::STABILIZE:
+        {
+            prev_passive_mode_[lander_id] = static_cast<int64_t>(mode);
+            //fallthrough
+        }
+        case Rocket::RcsEngineMode::CCW:
+        case Rocket::RcsEngineMode::CW:
+        {
+            rcs_mode_[lander_id] = static_cast<int64_t>(mode);
+            return;
+        }
+    }
+}
+
+void RocketEnsemble::switch_rcs_stabilization_mode(size_t lander_id)
+{
+    int64_t mode = static_cast<int64_t>(prev_passive_mode_[lander_id] == static_cast<int64_t>(Rocket::RcsEngineMode::IDLE) ?
+                                        Rocket::RcsEngineMode::STABILIZE : Rocket::RcsEngineMode::IDLE);
+    rcs_mode_[lander_id] = prev_passive_mode_[lander_id] = mode;
+}
+
+Vector2d RocketEnsemble::get_position(size_t lander_id) const
+{
+    return Vector2d(position_x_[lander_id], position_y_[lander_id]);
+}
+
+Vector2d RocketEnsemble::get_velocity(size_t lander_id) const
+{
+    return Vector2d(velocity_x_[lander_id], velocity_y_[lander_id]);
+}
+
+double RocketEnsemble::get_angle(size_t lander_id) const
+{
+    return angle_[lander_id];
+}
+
+double RocketEnsemble::get_rotation_speed(size_t lander_id) const
+{
+    return rotation_speed_[lander_id];
+}
+
+double RocketEnsemble::get_thrust(size_t lander_id) const
+{
+    return thrust_[lander_id];
+}
+
+double RocketEnsemble::get_fuel(size_t lander_id) const
+{
+    return fuel_[lander_id];
+}
+
+double RocketEnsemble::get_hydrazine(size_t lander_id) const
+{
+    return hydrazine_[lander_id];
+}
+
+Rocket::EngineMode RocketEnsemble::get_engine_mode(size_t lander_id) const
+{
+    return static_cast<Rocket::EngineMode>(engine_mode_[lander_id]);
+}
+
+Rocket::RcsEngineMode RocketEnsemble::get_rcs_mode(size_t lander_id) const
+{
+    return static_cast<Rocket::RcsEngineMode>(rcs_mode_[lander_id]);
+}
+
+// New padding landers have empty tanks, so their engines never fire
+void RocketEnsemble::resize_arrays(size_t size)
+{
+    for (std::vector<double> *array : {&position_x_, &position_y_, &velocity_x_, &velocity_y_, &angle_,
+                                       &rotation_speed_, &thrust_, &fuel_, &hydrazine_, &sin_angle_, &cos_angle_})
+        array->resize(size, 0.0);
+
+    engine_mode_.resize(size, static_cast<int64_t>(Rocket::EngineMode::IDLE));
+    for (std::vector<int64_t> *array : {&rcs_mode_, &prev_passive_mode_})
+        array->resize(size, static_cast<int64_t>(Rocket::RcsEngineMode::IDLE));
+}
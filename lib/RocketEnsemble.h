@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Rocket.h"
+
+/*
+*   Flight state of many landers in structure of arrays form. update() is the
+*   same integration as Rocket::update (with update_thrust and
+*   update_rotation_accel_) written for Lanes_count landers at once with GCC
+*   vector extensions. Every lane gives bit for bit the numbers of a Rocket with
+*   the same parameters and input, only sin and cos are taken one lane at a time.
+*
+*   There are no parts, sprites or colliders here: collisions and drawing stay
+*   with Rocket. All landers share one set of parameters.
+*/
+class RocketEnsemble final
+{
+    public:
+        // Static preferences of the landers, the defaults are Rocket::set_default_configuration
+        struct Parameters
+        {
+            double mass                        = 1;
+            double max_rotation_thrust         = 1;
+            double max_thrust                  = 100;
+            double delta_thrust                = 100;
+            double max_fuel                    = 1;
+            double fuel_per_thrust             = 0.001;
+            double max_hydrazine               = 1;
+            double hydrazine_per_thrust        = 0.1;
+            double treshold_speed_for_stabilize = 0.001;
+            Vector2d free_fall_accel           = Vector2d(0, 20);
+        };
+
+        RocketEnsemble();
+        explicit RocketEnsemble(const Parameters &parameters);
+
+        // Adds a lander in the default configuration (at rest, full tanks, engines off)
+        size_t add(Vector2d position);
+        void reset(size_t lander_id, Vector2d position);
+        void clear();
+
+        size_t get_count() const;
+        const Parameters &get_parameters() const;
+
+        void update(double dt);
+
+        /*
+        *   Methods for lander control, same as for Rocket
+        */
+        void toggle_engine(size_t lander_id, Rocket::EngineMode mode);
+        void toggle_rcs(size_t lander_id, Rocket::RcsEngineMode mode);
+        void switch_rcs_stabilization_mode(size_t lander_id);
+
+        Vector2d get_position(size_t lander_id) const;
+        Vector2d get_velocity(size_t lander_id) const;
+        double get_angle(size_t lander_id) const;
+        double get_rotation_speed(size_t lander_id) const;
+        double get_thrust(size_t lander_id) const;
+        double get_fuel(size_t lander_id) const;
+        double get_hydrazine(size_t lander_id) const;
+        Rocket::EngineMode get_engine_mode(size_t lander_id) const;
+        Rocket::RcsEngineMode get_rcs_mode(size_t lander_id) const;
+
+        // As wide as a native vector register, see Narrowphase
+#ifdef __AVX__
+        static constexpr size_t Lanes_count = 4;
+#else
+        static constexpr size_t Lanes_count = 2;
+#endif
+
+    private:
+        Parameters parameters_;
+        size_t count_;
+
+        // Arrays are padded to a whole number of lanes, padding landers are updated but never read
+        std::vector<double> position_x_;
+        std::vector<double> position_y_;
+        std::vector<double> velocity_x_;
+        std::vector<double> velocity_y_;
+        std::vector<double> angle_;
+        std::vector<double> rotation_speed_;
+        std::vector<double> thrust_;
+        std::vector<double> fuel_;
+        std::vector<double> hydrazine_;
+
+        // Rocket::EngineMode and Rocket::RcsEngineMode values
+        std::vector<int64_t> engine_mode_;
+        std::vector<int64_t> rcs_mode_;
+        std::vector<int64_t> prev_passive_mode_;
+
+        // Sines and cosines of the angles, filled lane by lane before the vector part of update
+        std::vector<double> sin_angle_;
+        std::vector<double> cos_angle_;
+
+        void resize_arrays(size_t size);
+};
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "RotationCache.h"
+
+size_t RotationCache::Image::get_memory_usage() const
+{
+    return pixels.size() * sizeof(uint32_t) + row_spans.size() * sizeof(std::pair<int, int>);
+}
+
+RotationCache::RotationCache(size_t angles_count, size_t memory_budget):
+    images_(std::max<size_t>(angles_count, 1)),
+    is_built_(images_.size(), false),
+    build_order_(),
+    memory_budget_(memory_budget),
+    memory_usage_(0)
+    {}
+
+size_t RotationCache::get_angles_count() const
+{
+    return images_.size();
+}
+
+size_t RotationCache::get_memory_budget() const
+{
+    return memory_budget_;
+}
+
+size_t RotationCache::get_memory_usage() const
+{
+    return memory_usage_;
+}
+
+size_t RotationCache::get_angle_id(double angle) const
+{
+    double turns = angle / (2 * std::numbers::pi);
+    turns -= std::floor(turns);
+
+    size_t angle_id = std::lround(turns * images_.size());
+    return angle_id % images_.size();
+}
+
+double RotationCache::get_angle(size_t angle_id) const
+{
+    return 2 * std::numbers::pi * angle_id / images_.size();
+}
+
+const RotationCache::Image *RotationCache::find(size_t angle_id) const
+{
+    return is_built_[angle_id] ? &images_[angle_id] : nullptr;
+}
+
+const RotationCache::Image *RotationCache::insert(size_t angle_id, Image &&image)
+{
+    size_t image_memory = image.get_memory_usage();
+    if (image_memory > memory_budget_)
+        return nullptr;
+
+    while (memory_usage_ + image_memory > memory_budget_ && !build_order_.empty())
+    {
+        size_t oldest_id = build_order_.front();
+        build_order_.pop_front();
+
+        memory_usage_ -= images_[oldest_id].get_memory_usage();
+        images_[oldest_id] = Image();
+        is_built_[oldest_id] = false;
+    }
+
+    images_[angle_id] = std::move(image);
+    is_built_[angle_id] = true;
+    build_order_.push_back(angle_id);
+    memory_usage_ += image_memory;
+
+    return &images_[angle_id];
+}
+
+void RotationCache::clear()
+{
+    for (size_t angle_id : build_order_)
+    {
+        images_[angle_id] = Image();
+        is_built_[angle_id] = false;
+    }
+
+    build_order_.clear();
+    memory_usage_ = 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+*   Storage for images of one texture pre-rotated at angles_count evenly
+*   spaced angles. Images are added lazily; when the memory budget would be
+*   exceeded, the oldest images are dropped first.
+*/
+class RotationCache final
+{
+    public:
+        struct Image
+        {
+            int width  = 0;
+            int height = 0;
+
+            // Offset of the image's top left pixel from the (rounded) sprite position
+            int origin_x = 0;
+            int origin_y = 0;
+
+            std::vector<uint32_t> pixels;
+
+            // Covered part [first, last) of every row, pixels outside are not drawn
+            std::vector<std::pair<int, int>> row_spans;
+
+            size_t get_memory_usage() const;
+        };
+
+        RotationCache(size_t angles_count, size_t memory_budget);
+
+        size_t get_angles_count() const;
+        size_t get_memory_budget() const;
+        size_t get_memory_usage() const;
+
+        size_t get_angle_id(double angle) const;
+        double get_angle(size_t angle_id) const;
+
+        const Image *find(size_t angle_id) const;
+        const Image *insert(size_t angle_id, Image &&image);
+
+        void clear();
+
+    private:
+        std::vector<Image> images_;
+        std::vector<bool> is_built_;
+        std::deque<size_t> build_order_;
+
+        size_t memory_budget_;
+        size_t memory_usage_;
+};
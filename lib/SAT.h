@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+/*
+*   Separating axis test for convex polygons inflated by a radius (a circle is
+*   one vertex with a radius, a capsule is two). Vertices must go around the
+*   polygon in order, either direction. Candidate axes are the edge normals of
+*   both polygons and, if any of them is rounded, the directions between every
+*   pair of vertices. The sizes are template parameters, so every pair of shapes
+*   gets its own fully unrolled kernel. The scalar type T is deduced from the
+*   vertices, so the test runs in float or double.
+*
+*   Returns {true, 0} if a separating axis exists, otherwise {false, mtv}, where
+*   mtv is the shortest translation of lhs that takes it out of rhs.
+*/
+
+template<typename T, size_t number_of_vertices>
+Vector2<T> get_min_max_projection_coord(const std::array<Vector2<T>, number_of_vertices> &array, Vector2<T> target_axis)
+{
+    T min = target_axis.dot(array[0]);
+    T max = min;
+    for (size_t i = 1; i < number_of_vertices; ++i)
+    {
+        T coord = target_axis.dot(array[i]);
+        min = std::min(min, coord);
+        max = std::max(max, coord);
+    }
+
+    return Vector2<T>(min, max);
+}
+
+// Signed translation of lhs along the unit target_axis, {true, 0} if the axis separates
+template<typename T, size_t first_vertices, size_t second_vertices>
+std::pair<bool, T> SAT_check_one_axis(const std::array<Vector2<T>,  first_vertices> &lhs, Scalar_t<T> lhs_radius,
+                                      const std::array<Vector2<T>, second_vertices> &rhs, Scalar_t<T> rhs_radius,
+                                      Vector2<T> target_axis)
+{
+    Vector2<T> first  = get_min_max_projection_coord(lhs, target_axis);
+    Vector2<T> second = get_min_max_projection_coord(rhs, target_axis);
+    first  += Vector2<T>(-lhs_radius, lhs_radius);
+    second += Vector2<T>(-rhs_radius, rhs_radius);
+
+    if (first.x > second.y || first.y < second.x)
+        return {true, T(0)};
+
+    T push_back    = first.y - second.x;
+    T push_forward = second.y - first.x;
+    return {false, push_back < push_forward ? -push_back : push_forward};
+}
+
+template<typename T, size_t first_vertices, size_t second_vertices>
+class SATAxes final
+{
+    public:
+        SATAxes(const std::array<Vector2<T>,  first_vertices> &lhs, T lhs_radius,
+                const std::array<Vector2<T>, second_vertices> &rhs, T rhs_radius):
+            lhs_(lhs),
+            rhs_(rhs),
+            lhs_radius_(lhs_radius),
+            rhs_radius_(rhs_radius),
+            min_axis_(),
+            min_translation_(0),
+            has_axis_(false)
+            {}
+
+        // Returns false as soon as the axis separates the shapes
+        bool check(Vector2<T> axis)
+        {
+            T length_sq = axis.norm_sq();
+            if (length_sq < Min_axis_length_sq_)
+                return true;
+
+            axis /= std::sqrt(length_sq);
+            auto [axis_exists, translation] = SAT_check_one_axis(lhs_, lhs_radius_, rhs_, rhs_radius_, axis);
+            if (axis_exists)
+                return false;
+
+            if (!has_axis_ || std::abs(translation) < std::abs(min_translation_))
+            {
+                min_axis_ = axis;
+                min_translation_ = translation;
+                has_axis_ = true;
+            }
+            return true;
+        }
+
+        template<size_t number_of_vertices>
+        bool check_edges(const std::array<Vector2<T>, number_of_vertices> &polygon)
+        {
+            // A segment has a single edge, a point has none
+            constexpr size_t number_of_edges = number_of_vertices < 3 ? number_of_vertices - 1 : number_of_vertices;
+            for (size_t edge_id = 0; edge_id < number_of_edges; ++edge_id)
+            {
+                const Vector2<T> &next = polygon[(edge_id + 1) % number_of_vertices];
+                if (!check((next - polygon[edge_id]).normal()))
+                    return false;
+            }
+            return true;
+        }
+
+        bool check_vertex_pairs()
+        {
+            for (const Vector2<T> &first : lhs_)
+                for (const Vector2<T> &second : rhs_)
+                    if (!check(first - second))
+                        return false;
+            return true;
+        }
+
+        Vector2<T> get_mtv() const
+        {
+            return min_axis_ * min_translation_;
+        }
+
+    private:
+        const std::array<Vector2<T>,  first_vertices> &lhs_;
+        const std::array<Vector2<T>, second_vertices> &rhs_;
+        T lhs_radius_;
+        T rhs_radius_;
+
+        Vector2<T> min_axis_;
+        T min_translation_;
+        bool has_axis_;
+
+        static constexpr T Min_axis_length_sq_ = std::is_same_v<T, float> ? T(1e-12) : T(1e-18);
+};
+
+template<typename T, size_t first_vertices, size_t second_vertices>
+std::pair<bool, Vector2<T>> SAT_check(const std::array<Vector2<T>,  first_vertices> &lhs, Scalar_t<T> lhs_radius,
+                                      const std::array<Vector2<T>, second_vertices> &rhs, Scalar_t<T> rhs_radius)
+{
+    static_assert(first_vertices > 0 && second_vertices > 0, "Shapes need at least one vertex");
+
+    SATAxes<T, first_vertices, second_vertices> axes(lhs, lhs_radius, rhs, rhs_radius);
+    if (!axes.check_edges(lhs) || !axes.check_edges(rhs))
+        return {true, Vector2<T>()};
+
+    if (lhs_radius + rhs_radius > 0 && !axes.check_vertex_pairs())
+        return {true, Vector2<T>()};
+
+    return {false, axes.get_mtv()};
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+
+#include "SegmentBVH.h"
+
+SegmentBVH::SegmentBVH():
+    nodes_(),
+    ids_(),
+    leaf_boxes_()
+    {}
+
+void SegmentBVH::build(const std::vector<Segment> &segments)
+{
+    clear();
+    if (segments.empty())
+        return;
+
+    std::vector<AABB> boxes;
+    boxes.reserve(segments.size());
+    for (const Segment &segment : segments)
+        boxes.emplace_back(segment);
+
+    ids_.resize(segments.size());
+    for (uint32_t i = 0; i < ids_.size(); ++i)
+        ids_[i] = i;
+
+    nodes_.reserve(2 * segments.size() / Max_leaf_size_ + 1);
+    nodes_.emplace_back();
+    build_node(0, boxes, 0, ids_.size());
+
+    leaf_boxes_.reserve(ids_.size());
+    for (uint32_t id : ids_)
+        leaf_boxes_.push_back(boxes[id]);
+}
+
+void SegmentBVH::clear()
+{
+    nodes_.clear();
+    ids_.clear();
+    leaf_boxes_.clear();
+}
+
+bool SegmentBVH::is_empty() const
+{
+    return nodes_.empty();
+}
+
+void SegmentBVH::query(const AABB &box, std::vector<uint32_t> &segment_ids) const
+{
+    query(box, [&segment_ids](uint32_t segment_id) { segment_ids.push_back(segment_id); });
+}
+
+/*
+*   Top-down build: the segments are split at the median of their centers
+*   along the longer side of the node box. Median splits keep the depth at
+*   log2(n / Max_leaf_size_), well below Max_depth_.
+*/
+void SegmentBVH::build_node(size_t node_id, const std::vector<AABB> &boxes, uint32_t first, uint32_t count)
+{
+    AABB node_box = boxes[ids_[first]];
+    for (uint32_t i = first + 1; i < first + count; ++i)
+    {
+        const AABB &box = boxes[ids_[i]];
+        node_box.left   = std::min(node_box.left  , box.left  );
+        node_box.right  = std::max(node_box.right , box.right );
+        node_box.top    = std::max(node_box.top   , box.top   );
+        node_box.bottom = std::min(node_box.bottom, box.bottom);
+    }
+    nodes_[node_id].box = node_box;
+
+    if (count <= Max_leaf_size_)
+    {
+        nodes_[node_id].first = first;
+        nodes_[node_id].count = count;
+        return;
+    }
+
+    bool split_x = node_box.right - node_box.left >= node_box.top - node_box.bottom;
+    auto center = [&boxes, split_x](uint32_t id)
+    {
+        const AABB &box = boxes[id];
+        return split_x ? box.left + box.right : box.bottom + box.top;
+    };
+
+    uint32_t half = count / 2;
+    auto begin = ids_.begin() + first;
+    std::nth_element(begin, begin + half, begin + count,
+                     [&center](uint32_t lhs, uint32_t rhs) { return center(lhs) < center(rhs); });
+
+    uint32_t children = nodes_.size();
+    nodes_[node_id].first = children;
+    nodes_[node_id].count = 0;
+    nodes_.emplace_back();
+    nodes_.emplace_back();
+
+    build_node(children    , boxes, first       , half        );
+    build_node(children + 1, boxes, first + half, count - half);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Collider.h"
+
+/*
+*   Bounding volume hierarchy over arbitrary segments (not only a height map,
+*   so overhangs and caves are fine). A query reports the ids (positions in the
+*   vector given to build) of segments whose AABB intersects the box, in
+*   O(log n + k) for reasonably distributed segments.
+*/
+class SegmentBVH final
+{
+    public:
+        SegmentBVH();
+
+        void build(const std::vector<Segment> &segments);
+        void clear();
+
+        bool is_empty() const;
+
+        template<typename Func>
+        void query(const AABB &box, Func &&func) const;
+        void query(const AABB &box, std::vector<uint32_t> &segment_ids) const;
+
+    private:
+        // Leaf if count > 0: ids_[first, first + count), otherwise children are first and first + 1
+        struct Node
+        {
+            AABB box;
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<uint32_t> ids_;
+
+        // Boxes of the segments in the order of ids_
+        std::vector<AABB> leaf_boxes_;
+
+        static constexpr size_t Max_leaf_size_ = 4;
+        static constexpr size_t Max_depth_ = 64;
+
+        void build_node(size_t node_id, const std::vector<AABB> &boxes, uint32_t first, uint32_t count);
+};
+
+template<typename Func>
+void SegmentBVH::query(const AABB &box, Func &&func) const
+{
+    if (nodes_.empty())
+        return;
+
+    uint32_t stack[Max_depth_];
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const Node &node = nodes_[stack[--stack_size]];
+        if (!node.box.is_intersect(box))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (leaf_boxes_[i].is_intersect(box))
+                    func(ids_[i]);
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.first;
+        stack[stack_size++] = node.first + 1;
+    }
+}
@@ -0,0 +1,61 @@
+#include "ShapeCollider.h"
+
+const AABB &ShapeCollider::get_AABB() const
+{
+    return std::visit([](const Collider &shape) -> const AABB & { return shape.get_AABB(); }, shape_);
+}
+
+bool ShapeCollider::check_AABB_segment_collision(const Segment &other) const
+{
+    return std::visit([&other](const Collider &shape) { return shape.check_AABB_segment_collision(other); }, shape_);
+}
+
+std::pair<bool, Vector2d> ShapeCollider::check_collision(const Segment &other) const
+{
+    return std::visit([&other](const auto &shape) { return shape.check_collision(other); }, shape_);
+}
+
+std::pair<bool, Vector2d> ShapeCollider::check_collision(const ShapeCollider &other) const
+{
+    return std::visit([](const auto &lhs, const auto &rhs) { return lhs.check_collision(rhs); }, shape_, other.shape_);
+}
+
+void ShapeCollider::move(Vector2d offset)
+{
+    std::visit([offset](auto &shape) { shape.move(offset); }, shape_);
+}
+
+void ShapeCollider::rotate(double angle)
+{
+    std::visit([angle](auto &shape) { shape.rotate(angle); }, shape_);
+}
+
+void ShapeCollider::set_position(Vector2d position)
+{
+    std::visit([position](auto &shape) { shape.set_position(position); }, shape_);
+}
+
+void ShapeCollider::set_transform(Vector2d position, double angle)
+{
+    std::visit([position, angle](auto &shape) { shape.set_transform(position, angle); }, shape_);
+}
+
+const RectTransform &ShapeCollider::get_transform() const
+{
+    return std::visit([](const auto &shape) -> const RectTransform & { return shape.get_transform(); }, shape_);
+}
+
+Vector2d ShapeCollider::get_support_point(Vector2d direction) const
+{
+    return std::visit([direction](const auto &shape) { return shape.get_support_point(direction); }, shape_);
+}
+
+double ShapeCollider::get_thickness() const
+{
+    return std::visit([](const auto &shape) { return shape.get_thickness(); }, shape_);
+}
+
+const ShapeCollider::shape_t &ShapeCollider::get_shape() const
+{
+    return shape_;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "CapsuleCollider.h"
+#include "CircleCollider.h"
+#include "RectCollider.h"
+
+using TriangleCollider = ConvexCollider<3>;
+
+/*
+*   Any of the collider shapes. Calls are dispatched with std::visit, so a pair
+*   of shapes resolves through a jump table to the SAT kernel instantiated for
+*   exactly these vertex counts, without virtual calls.
+*/
+class ShapeCollider final
+{
+    public:
+        using shape_t = std::variant<RectCollider, TriangleCollider, CircleCollider, CapsuleCollider>;
+
+        template<typename Shape>
+            requires std::is_constructible_v<shape_t, Shape>
+        ShapeCollider(Shape shape):
+            shape_(std::move(shape))
+            {}
+
+        const AABB &get_AABB() const;
+        bool check_AABB_segment_collision(const Segment &other) const;
+
+        std::pair<bool, Vector2d> check_collision(const Segment &other) const;
+        std::pair<bool, Vector2d> check_collision(const ShapeCollider &other) const;
+
+        void move(Vector2d offset);
+        void rotate(double angle);
+        void set_position(Vector2d position);
+        void set_transform(Vector2d position, double angle);
+
+        const RectTransform &get_transform() const;
+        Vector2d get_support_point(Vector2d direction) const;
+        double get_thickness() const;
+
+        const shape_t &get_shape() const;
+
+        template<typename Func>
+        decltype(auto) visit(Func &&func) const
+        {
+            return std::visit(std::forward<Func>(func), shape_);
+        }
+
+    private:
+        shape_t shape_;
+};
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <utility>
+
+#include "Simulation.h"
+
+Simulation::Simulation(size_t width, size_t height, uint32_t seed):
+    width_(width),
+    height_(height),
+    seed_(seed),
+    rocket_(Vector2d(50, 80)),
+    planet_(width, height, Color(200, 200, 200), seed),
+    contacts_(),
+    time_(0.0),
+    steps_count_(0)
+    {
+        contacts_.reserve(Probable_max_number_of_contacts_);
+        restart(seed);
+    }
+
+void Simulation::restart(uint32_t seed)
+{
+    generate_planet(planet_, seed);
+    start_episode(seed);
+}
+
+void Simulation::restart(uint32_t seed, Planet &planet)
+{
+    std::swap(planet_, planet);
+    start_episode(seed);
+}
+
+void Simulation::generate_planet(Planet &planet, uint32_t seed) const
+{
+    planet.set_seed(seed);
+    planet.generate_stars();
+    // A point every 32 pixels, narrow worlds still get their points
+    planet.generate_landscape(std::max<size_t>(width_ >> 5, 1), height_ / 4, 150);
+}
+
+void Simulation::start_episode(uint32_t seed)
+{
+    seed_ = seed;
+
+    rocket_.set_default_configuration();
+    rocket_.set_position(width_ / 10, height_ / 10);
+
+    time_ = 0.0;
+    steps_count_ = 0;
+}
+
+void Simulation::step(float dt)
+{
+    time_ += dt;
+    ++steps_count_;
+
+    float time_of_impact = get_time_of_impact(dt);
+    if (0 < time_of_impact && time_of_impact < 1)
+    {
+        rocket_.update(dt * time_of_impact);
+        handle_collisions(dt * time_of_impact);
+        dt *= 1 - time_of_impact;
+    }
+
+    rocket_.update(dt);
+    handle_collisions(dt);
+}
+
+Rocket::RocketState Simulation::run_episode(uint32_t seed, const InputPolicy &policy, float dt, size_t max_steps)
+{
+    restart(seed);
+
+    while (steps_count_ < max_steps && rocket_.get_state() == Rocket::RocketState::IN_FLIGHT && !is_rocket_outside())
+    {
+        if (policy)
+            policy(rocket_, time_);
+
+        step(dt);
+    }
+
+    return rocket_.get_state();
+}
+
+// The ground closes the world from below, anything that went past the other edges never comes back
+bool Simulation::is_rocket_outside() const
+{
+    Vector2d position = rocket_.get_position();
+    return position.x < 0 || position.x > width_ || position.y > height_;
+}
+
+uint32_t Simulation::get_seed() const
+{
+    return seed_;
+}
+
+double Simulation::get_time() const
+{
+    return time_;
+}
+
+size_t Simulation::get_steps_count() const
+{
+    return steps_count_;
+}
+
+Rocket &Simulation::get_rocket()
+{
+    return rocket_;
+}
+
+const Rocket &Simulation::get_rocket() const
+{
+    return rocket_;
+}
+
+Planet &Simulation::get_planet()
+{
+    return planet_;
+}
+
+const Planet &Simulation::get_planet() const
+{
+    return planet_;
+}
+
+void Simulation::handle_collisions(float dt)
+{
+    planet_.check_collisions(rocket_.get_colliders(), contacts_, dt);
+    rocket_.resolve_contacts(contacts_, dt);
+}
+
+// Earliest fraction of the step at which any rocket part touches the ground
+float Simulation::get_time_of_impact(float dt) const
+{
+    Vector2d center = rocket_.get_position();
+    Vector2d offset = rocket_.get_velocity() * dt;
+    double angle    = rocket_.get_rotation_speed() * dt;
+
+    double time_of_impact = 1;
+    for (const auto &collider : rocket_.get_colliders())
+        time_of_impact = std::min(time_of_impact, planet_.get_time_of_impact(collider, center, offset, angle));
+
+    return time_of_impact;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Planet.h"
+#include "Rocket.h"
+
+/*
+*   Rocket flying over a planet with the collision handling of the game and
+*   nothing else: no window, no input devices and no drawing. A simulation owns
+*   all of its state, so independent simulations can run on different threads.
+*/
+class Simulation final
+{
+    public:
+        // Controls the rocket before each step, time is counted from the restart
+        using InputPolicy = std::function<void(Rocket &rocket, double time)>;
+
+        Simulation(size_t width, size_t height, uint32_t seed = Planet::Default_seed);
+
+        // Generates a new planet from the seed and puts the default rocket at the start
+        void restart(uint32_t seed);
+
+        /*
+        *   Same as restart(seed) with a planet made ahead by generate_planet for
+        *   this seed. The planet is swapped in, the old one is left in its place.
+        */
+        void restart(uint32_t seed, Planet &planet);
+
+        // Makes the planet restart(seed) would, touches nothing else of the simulation
+        void generate_planet(Planet &planet, uint32_t seed) const;
+
+        // One step of dt: contacts are resolved at the moment of impact, the rest of the step goes on after them
+        void step(float dt);
+
+        /*
+        *   Restarts with the seed and steps until the rocket lands, crashes,
+        *   leaves the world or max_steps pass. Returns the final state.
+        */
+        Rocket::RocketState run_episode(uint32_t seed, const InputPolicy &policy, float dt, size_t max_steps);
+
+        bool is_rocket_outside() const;
+
+        uint32_t get_seed() const;
+        double get_time() const;
+        size_t get_steps_count() const;
+
+        Rocket &get_rocket();
+        const Rocket &get_rocket() const;
+        Planet &get_planet();
+        const Planet &get_planet() const;
+
+    private:
+        size_t width_;
+        size_t height_;
+        uint32_t seed_;
+
+        Rocket rocket_;
+        Planet planet_;
+        std::vector<Contact> contacts_;
+
+        double time_;
+        size_t steps_count_;
+
+        void start_episode(uint32_t seed);
+        void handle_collisions(float dt);
+        float get_time_of_impact(float dt) const;
+
+        static constexpr size_t Probable_max_number_of_contacts_ = 16;
+};
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "SleepIslands.h"
+
+SleepIslands::SleepIslands():
+    parents_(),
+    ranks_(),
+    resting_frames_(),
+    sleeping_(),
+    island_is_awake_()
+    {}
+
+size_t SleepIslands::add_body()
+{
+    parents_.push_back(parents_.size());
+    ranks_.push_back(0);
+    resting_frames_.push_back(0);
+    sleeping_.push_back(false);
+    island_is_awake_.push_back(false);
+
+    return parents_.size() - 1;
+}
+
+size_t SleepIslands::get_bodies_count() const
+{
+    return parents_.size();
+}
+
+// Sleeping islands keep their links, so waking one body still wakes its whole island
+void SleepIslands::begin_frame()
+{
+    for (uint32_t body_id = 0; body_id < parents_.size(); ++body_id)
+    {
+        if (sleeping_[body_id])
+            continue;
+
+        parents_[body_id] = body_id;
+        ranks_[body_id] = 0;
+    }
+}
+
+void SleepIslands::add_contact(size_t lhs_body_id, size_t rhs_body_id)
+{
+    unite(lhs_body_id, rhs_body_id);
+}
+
+void SleepIslands::report_motion(size_t body_id, Vector2d velocity, double angular_velocity, bool is_supported)
+{
+    bool is_resting = is_supported &&
+                      velocity.norm_sq() < Sleep_speed * Sleep_speed &&
+                      std::abs(angular_velocity) < Sleep_angular_speed;
+
+    if (!is_resting)
+        resting_frames_[body_id] = 0;
+    else if (resting_frames_[body_id] < Frames_to_sleep)
+        ++resting_frames_[body_id];
+}
+
+void SleepIslands::end_frame()
+{
+    size_t bodies_count = parents_.size();
+
+    std::fill(island_is_awake_.begin(), island_is_awake_.end(), false);
+    for (uint32_t body_id = 0; body_id < bodies_count; ++body_id)
+    {
+        if (resting_frames_[body_id] < Frames_to_sleep)
+            island_is_awake_[find(body_id)] = true;
+    }
+
+    for (uint32_t body_id = 0; body_id < bodies_count; ++body_id)
+        sleeping_[body_id] = !island_is_awake_[find(body_id)];
+}
+
+void SleepIslands::wake(size_t body_id)
+{
+    uint32_t island = find(body_id);
+    for (uint32_t other_id = 0; other_id < parents_.size(); ++other_id)
+    {
+        if (find(other_id) == island)
+        {
+            resting_frames_[other_id] = 0;
+            sleeping_[other_id] = false;
+        }
+    }
+}
+
+bool SleepIslands::is_sleeping(size_t body_id) const
+{
+    return sleeping_[body_id];
+}
+
+size_t SleepIslands::get_island(size_t body_id)
+{
+    return find(body_id);
+}
+
+uint32_t SleepIslands::find(uint32_t body_id)
+{
+    // Path halving
+    while (parents_[body_id] != body_id)
+    {
+        parents_[body_id] = parents_[parents_[body_id]];
+        body_id = parents_[body_id];
+    }
+
+    return body_id;
+}
+
+void SleepIslands::unite(uint32_t lhs_body_id, uint32_t rhs_body_id)
+{
+    uint32_t lhs_root = find(lhs_body_id);
+    uint32_t rhs_root = find(rhs_body_id);
+    if (lhs_root == rhs_root)
+        return;
+
+    if (ranks_[lhs_root] < ranks_[rhs_root])
+        std::swap(lhs_root, rhs_root);
+
+    parents_[rhs_root] = lhs_root;
+    if (ranks_[lhs_root] == ranks_[rhs_root])
+        ++ranks_[lhs_root];
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vector.h"
+
+/*
+*   Sleep bookkeeping for dynamic bodies. Bodies touching each other are
+*   joined into islands through the contact graph (union-find rebuilt every
+*   frame, static ground does not join anything). A body is resting while it
+*   is supported and slower than the thresholds. An island falls asleep once
+*   all its bodies have been resting for Frames_to_sleep frames, and wakes up
+*   as a whole. Sleeping bodies are meant to skip integration, transform
+*   updates and collision queries until something wakes them.
+*
+*   Per frame: begin_frame, then add_contact and report_motion for awake bodies, then end_frame.
+*/
+class SleepIslands final
+{
+    public:
+        SleepIslands();
+
+        size_t add_body();
+        size_t get_bodies_count() const;
+
+        void begin_frame();
+        void add_contact(size_t lhs_body_id, size_t rhs_body_id);
+        void report_motion(size_t body_id, Vector2d velocity, double angular_velocity, bool is_supported);
+        void end_frame();
+
+        // Wakes the body together with its island (of the last frame), e.g. on control input
+        void wake(size_t body_id);
+
+        bool is_sleeping(size_t body_id) const;
+        size_t get_island(size_t body_id);
+
+        static constexpr uint32_t Frames_to_sleep     = 30;
+        static constexpr double   Sleep_speed         = 0.1;
+        static constexpr double   Sleep_angular_speed = 0.01;
+
+    private:
+        std::vector<uint32_t> parents_;
+        std::vector<uint32_t> ranks_;
+        std::vector<uint32_t> resting_frames_;
+        std::vector<bool> sleeping_;
+
+        // Island roots whose bodies are not all ready to sleep
+        std::vector<bool> island_is_awake_;
+
+        uint32_t find(uint32_t body_id);
+        void unite(uint32_t lhs_body_id, uint32_t rhs_body_id);
+};
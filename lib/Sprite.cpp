@@ -1,18 +1,30 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <numbers>
 
+#include "RenderQueue.h"
 #include "Sprite.h"
 
-Sprite::Sprite(const RectTexture &rect, bool expand):
+Sprite::Sprite(const RectTexture &rect):
     transform_(Vector2d(rect.get_width(), rect.get_height())),
-    rect_(rect),
-    expand_on_rotate_(expand)
+    rect_(std::make_shared<RectTexture>(rect)),
+    is_texture_owned_(true),
+    rotation_cache_()
     {}
 
-Sprite::Sprite(RectTexture &&rect, bool expand):
+Sprite::Sprite(RectTexture &&rect):
     transform_(Vector2d(rect.get_width(), rect.get_height())),
+    rect_(std::make_shared<RectTexture>(std::move(rect))),
+    is_texture_owned_(true),
+    rotation_cache_()
+    {}
+
+Sprite::Sprite(std::shared_ptr<const RectTexture> rect):
+    transform_(Vector2d(rect->get_width(), rect->get_height())),
     rect_(std::move(rect)),
-    expand_on_rotate_(expand)
+    is_texture_owned_(false),
+    rotation_cache_()
     {}
 
 double Sprite::get_sin_phi()
@@ -28,11 +40,17 @@ double Sprite::get_cos_phi()
 void Sprite::set_center(int x, int y)
 {
     transform_.set_pivot(Vector2d(x, y));
+    reset_rotation_cache();
+}
+
+void Sprite::enable_rotation_cache(size_t angles_count, size_t memory_budget)
+{
+    rotation_cache_ = std::make_shared<RotationCache>(angles_count, memory_budget);
 }
 
-void Sprite::set_expand(bool expand)
+void Sprite::disable_rotation_cache()
 {
-    expand_on_rotate_ = expand;
+    rotation_cache_.reset();
 }
 
 void Sprite::move(double x, double y)
@@ -50,6 +68,11 @@ void Sprite::rotate(double phi)
     transform_.rotate(phi);
 }
 
+void Sprite::set_angle(double phi)
+{
+    transform_.set_angle(phi);
+}
+
 void Sprite::set_position(double x, double y)
 {
     set_position(Vector2d(x, y));
@@ -72,57 +95,227 @@ const RectTransform &Sprite::get_transform() const
 
 RectTexture &Sprite::get_texture()
 {
-    return rect_;
+    reset_rotation_cache();
+
+    if (!is_texture_owned_ || rect_.use_count() > 1)
+    {
+        auto copy = std::make_shared<RectTexture>(*rect_);
+        rect_ = copy;
+        is_texture_owned_ = true;
+        return *copy;
+    }
+
+    // Made by make_shared<RectTexture> above or in a constructor, not a const object
+    return const_cast<RectTexture &>(*rect_);
 }
 
 const RectTexture &Sprite::get_texture() const
 {
-    return rect_;
+    return *rect_;
 }
 
 void Sprite::draw(uint32_t *buffer, size_t width, size_t height) const
 {
-    for (int y = 0; y < rect_.get_height(); ++y)
+    draw(buffer, width, height, ScreenRect(0, 0, width, height));
+}
+
+void Sprite::draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip) const
+{
+    ScreenRect target = clip.intersect(ScreenRect(0, 0, width, height));
+
+    if (const RotationCache::Image *image = get_cached_image())
     {
-        for (int x = 0; x < rect_.get_width(); ++x)
+        // The nearest pre-rotated image is blitted axis aligned at the rounded position
+        ScreenRect bounds = get_cached_image_bounds(*image);
+        ScreenRect visible = bounds.intersect(target);
+        for (int y = visible.top; y < visible.bottom; ++y)
         {
-            Color color = rect_.get_pixel_color(x + y * rect_.get_width());
-
-            Vector2d real_position = transform_.transform_point(Vector2d(x, y));
-            double x_real = real_position.x;
-            double y_real = real_position.y;
-
-            if (!expand_on_rotate_)
-            {
-                if (x_real < 0 || x_real >= width || y_real < 0 || y_real >= height)
-                    continue;
-
-                uint32_t id_in_screen_buf = static_cast<uint32_t>(x_real) + static_cast<uint32_t>(y_real) * width;
-                buffer[id_in_screen_buf] = color;
-            }
-            else
-            {
-                draw_pixel_with_interpolation(buffer, width, height, x_real, y_real, color);
-            }
+            int row = y - bounds.top;
+            auto [first, last] = image->row_spans[row];
+            first = std::max(first + bounds.left, visible.left );
+            last  = std::min(last  + bounds.left, visible.right);
+            if (first >= last)
+                continue;
+
+            const uint32_t *src = image->pixels.data() + static_cast<size_t>(row) * image->width + (first - bounds.left);
+            Color::blend_span(buffer + static_cast<size_t>(y) * width + first, src, last - first);
         }
+        return;
     }
+
+    rasterize(transform_, target, [buffer, width](int y, int x, const uint32_t *texels, int count)
+    {
+        Color::blend_span(buffer + static_cast<size_t>(y) * width + x, texels, count);
+    });
 }
 
-void Sprite::draw_pixel_with_interpolation(uint32_t *buffer, size_t width, size_t height, double x, double y, Color color) const
+void Sprite::submit(RenderQueue &queue, int z) const
 {
-    if (x < 0 || x >= width || y < 0 || y >= height)
+    queue.add_sprite(*this, z);
+}
+
+ScreenRect Sprite::get_screen_bounds() const
+{
+    if (const RotationCache::Image *image = get_cached_image())
+        return get_cached_image_bounds(*image);
+
+    return get_rotated_bounds(transform_);
+}
+
+/*
+*   Every pixel of the rotated bounding box is mapped back into the texture:
+*   texture = R(-phi) * (screen - position) + pivot. Along a scanline the
+*   texture coordinates change by (cos, -sin) per pixel, so they are stepped in
+*   fixed point. Each pixel is sampled at its center and visited once; covered
+*   texels inside clip are passed to span_func(y, x, texels, count) in chunks.
+*/
+template<typename SpanFunc>
+void Sprite::rasterize(const RectTransform &transform, const ScreenRect &clip, SpanFunc &&span_func) const
+{
+    const int tex_width  = rect_->get_width();
+    const int tex_height = rect_->get_height();
+    if (tex_width == 0 || tex_height == 0)
+        return;
+
+    ScreenRect bounds = get_rotated_bounds(transform).intersect(clip);
+    if (bounds.is_empty())
         return;
 
-    size_t x_floor = static_cast<size_t>(x);
-    size_t y_floor = static_cast<size_t>(y);
-    size_t x_ceil  = x_floor + 1;
-    size_t y_ceil  = y_floor + 1;
+    const int x_begin = bounds.left;
+    const int x_end   = bounds.right;
+
+    const double cos = transform.get_cos();
+    const double sin = transform.get_sin();
+    const Vector2d position = transform.get_position();
+    const Vector2d pivot    = transform.get_pivot();
+
+    const int32_t du = std::lround( cos * Fixed_point_one_);
+    const int32_t dv = std::lround(-sin * Fixed_point_one_);
+
+    const uint32_t *texture = rect_->get_buffer().data();
+
+    auto inside = [tex_width, tex_height](int32_t u, int32_t v)
+    {
+        return static_cast<uint32_t>(u >> Fixed_point_shift_) < static_cast<uint32_t>(tex_width) &&
+               static_cast<uint32_t>(v >> Fixed_point_shift_) < static_cast<uint32_t>(tex_height);
+    };
+
+    for (int y = bounds.top; y < bounds.bottom; ++y)
+    {
+        // Texture coordinates of the pixel (0, y); pixel x adds x * (du, dv)
+        const double rel_x = 0.5 - position.x;
+        const double rel_y = y + 0.5 - position.y;
+        const double u_row =  cos * rel_x + sin * rel_y + pivot.x;
+        const double v_row = -sin * rel_x + cos * rel_y + pivot.y;
+        const int32_t u_base = std::lround(u_row * Fixed_point_one_);
+        const int32_t v_base = std::lround(v_row * Fixed_point_one_);
+
+        // Analytic estimate of the span inside the texture, widened by one pixel
+        // and then trimmed with the exact fixed point test
+        double span_begin = x_begin;
+        double span_end   = x_end;
+        RectTexture::clip_span(u_row,  cos, tex_width , span_begin, span_end);
+        RectTexture::clip_span(v_row, -sin, tex_height, span_begin, span_end);
+
+        int x_first = span_begin;
+        int x_last  = span_end;
+        while (x_first < x_last && !inside(u_base + x_first * du, v_base + x_first * dv))
+            ++x_first;
+        while (x_last > x_first && !inside(u_base + (x_last - 1) * du, v_base + (x_last - 1) * dv))
+            --x_last;
+
+        uint32_t texels[Span_chunk_size_];
+        int32_t u = u_base + x_first * du;
+        int32_t v = v_base + x_first * dv;
+        for (int x = x_first; x < x_last; x += Span_chunk_size_)
+        {
+            int chunk = std::min(x_last - x, Span_chunk_size_);
+            for (int i = 0; i < chunk; ++i, u += du, v += dv)
+                texels[i] = texture[(v >> Fixed_point_shift_) * tex_width + (u >> Fixed_point_shift_)];
+
+            span_func(y, x, texels, chunk);
+        }
+    }
+}
+
+ScreenRect Sprite::get_rotated_bounds(const RectTransform &transform) const
+{
+    Vector2d size = transform.get_size();
+    const std::array<Vector2d, 4> local_corners = {
+        Vector2d(  0   ,   0   ),
+        Vector2d(size.x,   0   ),
+        Vector2d(  0   , size.y),
+        Vector2d(size.x, size.y)
+    };
+
+    std::array<Vector2d, 4> corners;
+    transform.get_matrix().transform_points(local_corners, corners);
+
+    double min_x = corners[0].x, max_x = corners[0].x;
+    double min_y = corners[0].y, max_y = corners[0].y;
+    for (const Vector2d &corner : corners)
+    {
+        min_x = std::min(min_x, corner.x);
+        max_x = std::max(max_x, corner.x);
+        min_y = std::min(min_y, corner.y);
+        max_y = std::max(max_y, corner.y);
+    }
+
+    return ScreenRect(std::floor(min_x), std::floor(min_y), std::ceil(max_x), std::ceil(max_y));
+}
 
-    double x_frac = x - x_floor;
-    double y_frac = y - y_floor;
+// Returns nullptr if the cache is disabled or the image does not fit into its budget
+const RotationCache::Image *Sprite::get_cached_image() const
+{
+    if (!rotation_cache_)
+        return nullptr;
 
-    buffer[y_floor * width + x_floor] = color.blend(buffer[y_floor * width + x_floor]);
+    size_t angle_id = rotation_cache_->get_angle_id(transform_.get_angle());
+    const RotationCache::Image *image = rotation_cache_->find(angle_id);
+    return image ? image : build_cached_image(angle_id);
+}
+
+ScreenRect Sprite::get_cached_image_bounds(const RotationCache::Image &image) const
+{
+    Vector2d position = transform_.get_position();
+    int left = std::lround(position.x) + image.origin_x;
+    int top  = std::lround(position.y) + image.origin_y;
+
+    return ScreenRect(left, top, left + image.width, top + image.height);
+}
+
+const RotationCache::Image *Sprite::build_cached_image(size_t angle_id) const
+{
+    // Bounding box of the texture rotated around the pivot placed at (0, 0)
+    Vector2d size  = transform_.get_size();
+    Vector2d pivot = transform_.get_pivot();
+    double angle   = rotation_cache_->get_angle(angle_id);
+    ScreenRect bounds = get_rotated_bounds(RectTransform(size, Vector2d(), pivot, angle));
 
-    if (x_frac > 0.5 && x_ceil < width)
-        buffer[y_floor * width + x_ceil] = color.blend(buffer[y_floor * width + x_ceil]);
-}
\ No newline at end of file
+    RotationCache::Image image;
+    image.origin_x = bounds.left;
+    image.origin_y = bounds.top;
+    image.width    = bounds.get_width();
+    image.height   = bounds.get_height();
+    image.pixels.assign(static_cast<size_t>(image.width) * image.height, 0);
+    image.row_spans.assign(image.height, {0, 0});
+
+    RectTransform placed(size, Vector2d(-image.origin_x, -image.origin_y), pivot, angle);
+    rasterize(placed, ScreenRect(0, 0, image.width, image.height), [&image](int y, int x, const uint32_t *texels, int count)
+    {
+        std::copy(texels, texels + count, image.pixels.begin() + static_cast<size_t>(y) * image.width + x);
+
+        auto &[first, last] = image.row_spans[y];
+        if (first == last)
+            first = x;
+        last = x + count;
+    });
+
+    return rotation_cache_->insert(angle_id, std::move(image));
+}
+
+void Sprite::reset_rotation_cache()
+{
+    if (rotation_cache_)
+        enable_rotation_cache(rotation_cache_->get_angles_count(), rotation_cache_->get_memory_budget());
+}
@@ -1,25 +1,46 @@
 #pragma once
 
+#include <memory>
+
+#include "DamageTracker.h"
 #include "RectTexture.h"
 #include "RectTransform.h"
+#include "RotationCache.h"
+
+class RenderQueue;
 
 class Sprite
 {
     public:
-        Sprite(const RectTexture &rect, bool expand = true);
-        Sprite(RectTexture &&rect, bool expand = true);
+        Sprite(const RectTexture &rect);
+        Sprite(RectTexture &&rect);
+
+        // Sprites made from one texture share it, the render queue draws them one after another
+        Sprite(std::shared_ptr<const RectTexture> rect);
         virtual ~Sprite() = default;
 
         double get_sin_phi();
         double get_cos_phi();
 
         void set_center(int x, int y);
-        void set_expand(bool expand);
+
+        /*
+        *   Draw through images pre-rotated at angles_count quantized angles.
+        *   Images are rendered on first use and dropped oldest first once
+        *   memory_budget bytes are used. Only worth it for textures that do not change.
+        */
+        void enable_rotation_cache(size_t angles_count = Default_cached_angles, size_t memory_budget = Default_cache_budget);
+        void disable_rotation_cache();
 
         void move(double x, double y);
         void move(Vector2d offset);
         void rotate(double phi);
+        void set_angle(double phi);
         void draw(uint32_t *buffer, size_t width, size_t height) const;
+        void draw(uint32_t *buffer, size_t width, size_t height, const ScreenRect &clip) const;
+        void submit(RenderQueue &queue, int z) const;
+
+        ScreenRect get_screen_bounds() const;
 
         void set_position(double x, double y);
         void set_position(Vector2d position);
@@ -27,15 +48,37 @@ class Sprite
         RectTransform &get_transform();
         const RectTransform &get_transform() const;
 
+        // A shared texture is copied here, the other sprites keep drawing the old one
         RectTexture &get_texture();
         const RectTexture &get_texture() const;
 
+        static constexpr size_t Default_cached_angles = 256;
+        static constexpr size_t Default_cache_budget  = 8 << 20;
+
     protected:
         RectTransform transform_;
 
     private:
-        RectTexture rect_;
-        bool expand_on_rotate_;
+        std::shared_ptr<const RectTexture> rect_;
+
+        // The texture was made by this sprite, so it may be changed when no one else holds it
+        bool is_texture_owned_;
+
+        // Shared between copies of the sprite, recreated when texture or pivot change
+        std::shared_ptr<RotationCache> rotation_cache_;
+
+        template<typename SpanFunc>
+        void rasterize(const RectTransform &transform, const ScreenRect &clip, SpanFunc &&span_func) const;
+
+        ScreenRect get_rotated_bounds(const RectTransform &transform) const;
+
+        const RotationCache::Image *get_cached_image() const;
+        const RotationCache::Image *build_cached_image(size_t angle_id) const;
+        ScreenRect get_cached_image_bounds(const RotationCache::Image &image) const;
+        void reset_rotation_cache();
 
-        void draw_pixel_with_interpolation(uint32_t *buffer, size_t width, size_t height, double x, double y, Color color) const;
+        // Texture coordinates are stepped along the scanline in 16.16 fixed point
+        static constexpr int Fixed_point_shift_ = 16;
+        static constexpr double Fixed_point_one_ = 1 << Fixed_point_shift_;
+        static constexpr int Span_chunk_size_ = 256;
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <algorithm>
+
+#include "TileRenderer.h"
+
+TileRenderer::TileRenderer(size_t width, size_t height, size_t threads_count, size_t tile_height, size_t tile_width):
+    width_(width),
+    height_(height),
+    tile_width_(std::max<size_t>(tile_width ? tile_width : width, 1)),
+    tile_height_(std::max<size_t>(tile_height, 1)),
+    tiles_x_((width + tile_width_ - 1) / tile_width_),
+    tiles_y_((height + tile_height_ - 1) / tile_height_),
+    pool_(threads_count),
+    tile_commands_(tiles_x_ * tiles_y_),
+    active_tiles_()
+    {
+        active_tiles_.reserve(tile_commands_.size());
+    }
+
+void TileRenderer::render(const RenderQueue &queue, uint32_t *buffer, const std::vector<ScreenRect> &areas)
+{
+    bin_commands(queue);
+
+    active_tiles_.clear();
+    for (size_t tile_id = 0; tile_id < tile_commands_.size(); ++tile_id)
+    {
+        if (tile_commands_[tile_id].empty())
+            continue;
+
+        ScreenRect tile = get_tile_rect(tile_id);
+        if (std::any_of(areas.begin(), areas.end(), [&tile](const ScreenRect &area) { return area.is_intersect(tile); }))
+            active_tiles_.push_back(tile_id);
+    }
+
+    // Tiles cost very different time (empty sky or the rocket), so they are dealt one by one
+    pool_.parallel_for(active_tiles_.size(), 1, [this, &queue, buffer, &areas](size_t begin, size_t end, size_t)
+    {
+        for (size_t i = begin; i < end; ++i)
+            render_tile(queue, buffer, active_tiles_[i], areas);
+    });
+}
+
+size_t TileRenderer::get_threads_count() const
+{
+    return pool_.get_threads_count();
+}
+
+void TileRenderer::bin_commands(const RenderQueue &queue)
+{
+    for (std::vector<uint32_t> &commands : tile_commands_)
+        commands.clear();
+
+    const std::vector<RenderCommand> &commands = queue.get_commands();
+    for (uint32_t command_id = 0; command_id < commands.size(); ++command_id)
+    {
+        ScreenRect visible = commands[command_id].bounds.intersect(ScreenRect(0, 0, width_, height_));
+        if (visible.is_empty())
+            continue;
+
+        size_t first_x = visible.left / tile_width_;
+        size_t first_y = visible.top  / tile_height_;
+        size_t last_x  = (visible.right  - 1) / tile_width_;
+        size_t last_y  = (visible.bottom - 1) / tile_height_;
+        for (size_t tile_y = first_y; tile_y <= last_y; ++tile_y)
+        {
+            for (size_t tile_x = first_x; tile_x <= last_x; ++tile_x)
+                tile_commands_[tile_y * tiles_x_ + tile_x].push_back(command_id);
+        }
+    }
+}
+
+ScreenRect TileRenderer::get_tile_rect(size_t tile_id) const
+{
+    int left = (tile_id % tiles_x_) * tile_width_;
+    int top  = (tile_id / tiles_x_) * tile_height_;
+    return ScreenRect(left, top, std::min<size_t>(left + tile_width_, width_), std::min<size_t>(top + tile_height_, height_));
+}
+
+// Areas go in the outer loop, as in SerialRenderer
+void TileRenderer::render_tile(const RenderQueue &queue, uint32_t *buffer, size_t tile_id, const std::vector<ScreenRect> &areas) const
+{
+    const std::vector<RenderCommand> &commands = queue.get_commands();
+    const std::vector<uint32_t> &command_ids = tile_commands_[tile_id];
+    ScreenRect tile = get_tile_rect(tile_id);
+
+    for (const ScreenRect &area : areas)
+    {
+        ScreenRect clip = area.intersect(tile);
+        if (clip.is_empty())
+            continue;
+
+        for (size_t i = queue.find_first_visible(command_ids, clip); i < command_ids.size(); ++i)
+        {
+            const RenderCommand &command = commands[command_ids[i]];
+            if (command.bounds.is_intersect(clip))
+                RenderQueue::execute(command, buffer, width_, height_, clip);
+        }
+    }
+}
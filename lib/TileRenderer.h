@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RenderBackend.h"
+#include "WorkStealingPool.h"
+
+/*
+*   Renders a queue tile by tile on several threads. The commands are binned
+*   into the tiles their bounds touch, and the tiles inside the render areas
+*   are drawn on the pool: the commands of a tile run in queue order with the
+*   clip cut to the tile, so every pixel goes through the same commands in
+*   the same order as with SerialRenderer and the frame is bit for bit the same.
+*
+*   Commands of different tiles run at once and only read the objects they
+*   point to; the lazy parts of the objects are built when they submit.
+*
+*   Tiles are whole rows by default: copies of opaque layers stay contiguous
+*   and a band of rows costs a single memcpy, as in a serial draw.
+*/
+class TileRenderer final : public RenderBackend
+{
+    public:
+        // Zero tile_width means whole rows
+        TileRenderer(size_t width, size_t height, size_t threads_count = WorkStealingPool::get_default_threads_count(),
+                     size_t tile_height = Default_tile_height, size_t tile_width = 0);
+
+        virtual void render(const RenderQueue &queue, uint32_t *buffer, const std::vector<ScreenRect> &areas) override;
+
+        size_t get_threads_count() const;
+
+        static constexpr size_t Default_tile_height = 32;
+
+    private:
+        size_t width_;
+        size_t height_;
+        size_t tile_width_;
+        size_t tile_height_;
+        size_t tiles_x_;
+        size_t tiles_y_;
+
+        WorkStealingPool pool_;
+
+        // Ids of the commands touching every tile, in queue order
+        std::vector<std::vector<uint32_t>> tile_commands_;
+
+        // Tiles with commands inside the render areas
+        std::vector<uint32_t> active_tiles_;
+
+        void bin_commands(const RenderQueue &queue);
+        ScreenRect get_tile_rect(size_t tile_id) const;
+        void render_tile(const RenderQueue &queue, uint32_t *buffer, size_t tile_id, const std::vector<ScreenRect> &areas) const;
+};
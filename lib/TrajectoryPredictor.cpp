@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <utility>
+
+#include "TrajectoryPredictor.h"
+
+namespace
+{
+    // Other modes to try after the current ones, the most telling first
+    constexpr std::pair<Rocket::EngineMode, Rocket::RcsEngineMode> Schedules[] = {
+        {Rocket::EngineMode::DECREASE_THRUST, Rocket::RcsEngineMode::STABILIZE},
+        {Rocket::EngineMode::INCREASE_THRUST, Rocket::RcsEngineMode::STABILIZE},
+        {Rocket::EngineMode::IDLE,            Rocket::RcsEngineMode::STABILIZE},
+        {Rocket::EngineMode::SET_MAX_THRUST,  Rocket::RcsEngineMode::STABILIZE},
+        {Rocket::EngineMode::INCREASE_THRUST, Rocket::RcsEngineMode::CW       },
+        {Rocket::EngineMode::INCREASE_THRUST, Rocket::RcsEngineMode::CCW      },
+        {Rocket::EngineMode::DECREASE_THRUST, Rocket::RcsEngineMode::CW       },
+        {Rocket::EngineMode::DECREASE_THRUST, Rocket::RcsEngineMode::CCW      },
+        {Rocket::EngineMode::IDLE,            Rocket::RcsEngineMode::CW       },
+        {Rocket::EngineMode::IDLE,            Rocket::RcsEngineMode::CCW      },
+        {Rocket::EngineMode::INCREASE_THRUST, Rocket::RcsEngineMode::IDLE     },
+        {Rocket::EngineMode::DECREASE_THRUST, Rocket::RcsEngineMode::IDLE     },
+        {Rocket::EngineMode::IDLE,            Rocket::RcsEngineMode::IDLE     },
+        {Rocket::EngineMode::SET_MAX_THRUST,  Rocket::RcsEngineMode::IDLE     },
+        {Rocket::EngineMode::SET_NO_THRUST,   Rocket::RcsEngineMode::STABILIZE},
+    };
+
+    static_assert(std::size(Schedules) + 1 >= TrajectoryPredictor::Max_rollouts_count);
+}
+
+/*
+*   Simulations are made here, on the thread of the caller: a new Rocket draws
+*   its fire with std::rand, which must not happen in the middle of a game.
+*/
+TrajectoryPredictor::TrajectoryPredictor(size_t world_width, size_t world_height, size_t threads_count):
+    pool_(threads_count),
+    simulations_(),
+    requests_(),
+    predictions_(),
+    wake_count_(0),
+    stopping_(false),
+    last_request_id_(0),
+    last_request_time_(),
+    horizon_steps_(Initial_horizon_steps_),
+    rollouts_count_(Min_rollouts_count),
+    thread_()
+    {
+        for (size_t worker_id = 0; worker_id < pool_.get_threads_count(); ++worker_id)
+            simulations_.push_back(std::make_unique<Simulation>(world_width, world_height));
+
+        thread_ = std::thread(&TrajectoryPredictor::thread_loop, this);
+    }
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+    stopping_.store(true, std::memory_order_release);
+    wake_count_.fetch_add(1, std::memory_order_release);
+    wake_count_.notify_one();
+
+    thread_.join();
+}
+
+void TrajectoryPredictor::request(const Rocket::Snapshot &snapshot, uint32_t seed)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    Request &request = requests_.get_write_buffer();
+    request.request_id = ++last_request_id_;
+    request.snapshot = snapshot;
+    request.seed = seed;
+    request.interval = last_request_time_ == std::chrono::steady_clock::time_point() ? std::chrono::duration<double>::zero()
+                                                                                    : now - last_request_time_;
+    last_request_time_ = now;
+
+    requests_.publish();
+    wake_count_.fetch_add(1, std::memory_order_release);
+    wake_count_.notify_one();
+}
+
+bool TrajectoryPredictor::update()
+{
+    return predictions_.update();
+}
+
+const TrajectoryPredictor::Prediction &TrajectoryPredictor::get_prediction() const
+{
+    return predictions_.get_read_buffer();
+}
+
+uint64_t TrajectoryPredictor::get_last_request_id() const
+{
+    return last_request_id_;
+}
+
+size_t TrajectoryPredictor::get_default_threads_count()
+{
+    return std::max<size_t>(WorkStealingPool::get_default_threads_count() - 1, 1);
+}
+
+void TrajectoryPredictor::thread_loop()
+{
+    uint32_t seen_wake_count = 0;
+    while (true)
+    {
+        wake_count_.wait(seen_wake_count, std::memory_order_acquire);
+        seen_wake_count = wake_count_.load(std::memory_order_acquire);
+
+        if (stopping_.load(std::memory_order_acquire))
+            return;
+
+        // Requests published while the last prediction was running are skipped, only the latest one counts
+        if (!requests_.update())
+            continue;
+
+        const Request &request = requests_.get_read_buffer();
+
+        auto start = std::chrono::steady_clock::now();
+        predict(request, predictions_.get_write_buffer());
+        predictions_.publish();
+        std::chrono::duration<double> prediction_time = std::chrono::steady_clock::now() - start;
+
+        if (request.interval > std::chrono::duration<double>::zero())
+            adapt(prediction_time, request.interval);
+    }
+}
+
+void TrajectoryPredictor::predict(const Request &request, Prediction &prediction)
+{
+    const size_t horizon_steps = horizon_steps_;
+
+    prediction.request_id = request.request_id;
+    prediction.horizon_steps = horizon_steps;
+    prediction.rollouts.resize(rollouts_count_);
+
+    for (size_t i = 0; i < prediction.rollouts.size(); ++i)
+    {
+        Rollout &rollout = prediction.rollouts[i];
+        if (i == 0)
+        {
+            rollout.engine_mode = request.snapshot.engine_mode;
+            rollout.rcs_mode    = request.snapshot.rcs_mode;
+        }
+        else
+        {
+            rollout.engine_mode = Schedules[i - 1].first;
+            rollout.rcs_mode    = Schedules[i - 1].second;
+        }
+    }
+
+    pool_.parallel_for(prediction.rollouts.size(), 1, [&](size_t begin, size_t end, size_t worker_id)
+    {
+        Simulation &simulation = *simulations_[worker_id];
+        if (simulation.get_seed() != request.seed)
+            simulation.restart(request.seed);
+
+        for (size_t i = begin; i < end; ++i)
+            run_rollout(simulation, request, prediction.rollouts[i], horizon_steps);
+    });
+}
+
+void TrajectoryPredictor::run_rollout(Simulation &simulation, const Request &request, Rollout &rollout, size_t horizon_steps)
+{
+    Rocket &rocket = simulation.get_rocket();
+    rocket.restore(request.snapshot);
+    rocket.toggle_engine(rollout.engine_mode);
+    rocket.toggle_rcs(rollout.rcs_mode);
+
+    rollout.verdict = Verdict::STILL_FLYING;
+    rollout.impact_time = horizon_steps * Step_dt;
+    rollout.touchdown_speed = 0;
+    rollout.trajectory.clear();
+
+    bool has_touched = false;
+    for (size_t step = 0; step < horizon_steps; ++step)
+    {
+        if (step % Trajectory_stride == 0)
+            rollout.trajectory.push_back(rocket.get_position());
+
+        Vector2d velocity = rocket.get_velocity();
+        simulation.step(Step_dt);
+
+        if (!has_touched && (rocket.has_contacts() || rocket.get_state() != Rocket::RocketState::IN_FLIGHT))
+        {
+            has_touched = true;
+            rollout.impact_time = (step + 1) * Step_dt;
+            rollout.touchdown_speed = velocity.norm();
+            rollout.impact_point = rocket.get_position();
+        }
+
+        if (rocket.get_state() == Rocket::RocketState::LANDED)
+        {
+            rollout.verdict = Verdict::LANDS;
+            break;
+        }
+        if (rocket.get_state() == Rocket::RocketState::CRASHED)
+        {
+            rollout.verdict = Verdict::CRASHES;
+            break;
+        }
+        if (simulation.is_rocket_outside())
+        {
+            rollout.verdict = Verdict::LEAVES_WORLD;
+            break;
+        }
+    }
+
+    rollout.trajectory.push_back(rocket.get_position());
+    if (!has_touched)
+        rollout.impact_point = rocket.get_position();
+}
+
+// The horizon grows first and shrinks last: the place of the touchdown matters more than the alternatives
+void TrajectoryPredictor::adapt(std::chrono::duration<double> prediction_time, std::chrono::duration<double> request_interval)
+{
+    double load = prediction_time / request_interval;
+
+    if (load < Target_load_ / 2)
+    {
+        if (horizon_steps_ < Max_horizon_steps)
+            horizon_steps_ = std::min<size_t>(horizon_steps_ * Growth_factor_, Max_horizon_steps);
+        else if (rollouts_count_ < Max_rollouts_count)
+            ++rollouts_count_;
+    }
+    else if (load > Target_load_)
+    {
+        if (rollouts_count_ > Min_rollouts_count)
+            --rollouts_count_;
+        else
+            horizon_steps_ = std::max<size_t>(horizon_steps_ / Growth_factor_, Min_horizon_steps);
+    }
+}
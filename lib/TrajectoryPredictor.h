@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Simulation.h"
+#include "TripleBuffer.h"
+#include "WorkStealingPool.h"
+
+/*
+*   Predicts where and how the rocket touches the ground. request() hands a
+*   snapshot of the rocket to a background thread, which flies copies of it
+*   over the same planet: once with the current engine and RCS modes and
+*   then with a fan of other modes held till the end. Rollouts run in
+*   parallel on a pool of worker threads, each worker has its own Simulation.
+*
+*   Requests and predictions go through lock-free slots, so the caller never
+*   waits: request() replaces a request that was not started yet and
+*   get_prediction() returns the latest finished prediction. The horizon and
+*   the number of rollouts grow while a prediction takes less than a half
+*   of the time between requests and shrink when it takes more.
+*/
+class TrajectoryPredictor final
+{
+    public:
+        enum class Verdict
+        {
+            LANDS,
+            CRASHES,
+            LEAVES_WORLD,
+            STILL_FLYING  // the horizon ended before the ground
+        };
+
+        struct Rollout
+        {
+            Rocket::EngineMode engine_mode;
+            Rocket::RcsEngineMode rcs_mode;
+
+            Verdict verdict;
+            Vector2d impact_point;   // position of the rocket at the first contact or at the end
+            double impact_time;
+            double touchdown_speed;  // speed just before the first contact
+
+            std::vector<Vector2d> trajectory;  // every Trajectory_stride-th position
+        };
+
+        struct Prediction
+        {
+            uint64_t request_id = 0;
+            size_t horizon_steps = 0;
+
+            // The first one holds the current modes of the rocket
+            std::vector<Rollout> rollouts;
+        };
+
+        TrajectoryPredictor(size_t world_width, size_t world_height,
+                            size_t threads_count = get_default_threads_count());
+        ~TrajectoryPredictor();
+
+        TrajectoryPredictor(const TrajectoryPredictor &) = delete;
+        TrajectoryPredictor &operator=(const TrajectoryPredictor &) = delete;
+
+        // seed is the seed of the planet the rocket flies over, see Simulation::get_seed
+        void request(const Rocket::Snapshot &snapshot, uint32_t seed);
+
+        // Takes the latest finished prediction, returns true if it is new
+        bool update();
+        const Prediction &get_prediction() const;
+
+        // Id of the last request, predictions carry the id of their request
+        uint64_t get_last_request_id() const;
+
+        // Leaves one core to the caller
+        static size_t get_default_threads_count();
+
+        static constexpr double Step_dt = 1.0 / 60;
+        static constexpr size_t Trajectory_stride = 4;
+
+        static constexpr size_t Min_horizon_steps = 60;
+        static constexpr size_t Max_horizon_steps = 1200;
+        static constexpr size_t Min_rollouts_count = 1;
+        static constexpr size_t Max_rollouts_count = 16;
+
+    private:
+        struct Request
+        {
+            uint64_t request_id = 0;
+            Rocket::Snapshot snapshot;
+            uint32_t seed = 0;
+
+            // Time since the previous request, the budget of a prediction
+            std::chrono::duration<double> interval;
+        };
+
+        WorkStealingPool pool_;
+        std::vector<std::unique_ptr<Simulation>> simulations_;
+
+        TripleBuffer<Request> requests_;
+        TripleBuffer<Prediction> predictions_;
+
+        // Bumped by every request and by the destructor, the background thread sleeps on it
+        std::atomic<uint32_t> wake_count_;
+        std::atomic<bool> stopping_;
+
+        // Owned by the caller
+        uint64_t last_request_id_;
+        std::chrono::steady_clock::time_point last_request_time_;
+
+        // Owned by the background thread
+        size_t horizon_steps_;
+        size_t rollouts_count_;
+
+        std::thread thread_;
+
+        void thread_loop();
+        void predict(const Request &request, Prediction &prediction);
+        void run_rollout(Simulation &simulation, const Request &request, Rollout &rollout, size_t horizon_steps);
+        void adapt(std::chrono::duration<double> prediction_time, std::chrono::duration<double> request_interval);
+
+        static constexpr size_t Initial_horizon_steps_ = 240;
+
+        static constexpr double Target_load_ = 0.5;
+        static constexpr double Growth_factor_ = 1.25;
+};
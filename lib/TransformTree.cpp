@@ -0,0 +1,113 @@
+#include <cmath>
+
+#include "TransformTree.h"
+
+TransformTree::TransformTree():
+    nodes_(),
+    has_dirty_nodes_(false)
+    {}
+
+size_t TransformTree::add_node(size_t parent_id, Vector2d local_position, double local_angle)
+{
+    TransformNode node{parent_id, local_position, local_angle, Affine2d(), 0.0, true, false};
+    nodes_.push_back(node);
+    has_dirty_nodes_ = true;
+
+    return nodes_.size() - 1;
+}
+
+size_t TransformTree::get_nodes_count() const
+{
+    return nodes_.size();
+}
+
+void TransformTree::set_local_position(size_t node_id, Vector2d position)
+{
+    nodes_[node_id].local_position = position;
+    mark_dirty(node_id);
+}
+
+void TransformTree::set_local_angle(size_t node_id, double angle)
+{
+    nodes_[node_id].local_angle = angle;
+    mark_dirty(node_id);
+}
+
+void TransformTree::move(size_t node_id, Vector2d offset)
+{
+    nodes_[node_id].local_position += offset;
+    mark_dirty(node_id);
+}
+
+void TransformTree::rotate(size_t node_id, double angle)
+{
+    nodes_[node_id].local_angle += angle;
+    mark_dirty(node_id);
+}
+
+Vector2d TransformTree::get_local_position(size_t node_id) const
+{
+    return nodes_[node_id].local_position;
+}
+
+double TransformTree::get_local_angle(size_t node_id) const
+{
+    return nodes_[node_id].local_angle;
+}
+
+bool TransformTree::is_dirty() const
+{
+    return has_dirty_nodes_;
+}
+
+// Parents go first, so a single pass sees a changed parent before its children
+void TransformTree::update()
+{
+    for (TransformNode &node : nodes_)
+    {
+        bool parent_changed = node.parent_id != No_parent && nodes_[node.parent_id].is_changed;
+        node.is_changed = node.is_dirty || parent_changed;
+        node.is_dirty = false;
+        if (!node.is_changed)
+            continue;
+
+        Vector2d world_position = node.local_position;
+        node.world_angle = node.local_angle;
+        if (node.parent_id != No_parent)
+        {
+            const TransformNode &parent = nodes_[node.parent_id];
+            world_position   = parent.world_matrix.apply(world_position);
+            node.world_angle += parent.world_angle;
+        }
+
+        node.world_matrix = Affine2d::rotation(node.world_angle, world_position);
+    }
+
+    has_dirty_nodes_ = false;
+}
+
+bool TransformTree::is_changed(size_t node_id) const
+{
+    return nodes_[node_id].is_changed;
+}
+
+Vector2d TransformTree::get_world_position(size_t node_id) const
+{
+    return nodes_[node_id].world_matrix.offset;
+}
+
+double TransformTree::get_world_angle(size_t node_id) const
+{
+    return nodes_[node_id].world_angle;
+}
+
+Vector2d TransformTree::transform_point(size_t node_id, Vector2d local_point) const
+{
+    return nodes_[node_id].world_matrix.apply(local_point);
+}
+
+void TransformTree::mark_dirty(size_t node_id)
+{
+    nodes_[node_id].is_dirty = true;
+    has_dirty_nodes_ = true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Affine.h"
+
+/*
+*   Hierarchy of 2D transforms (translation and rotation) stored flat with
+*   parents before children. Changing a local transform only marks the node
+*   dirty, so any number of moves in a frame cost O(1) each. update() then
+*   recomputes the world transforms of the dirty nodes and their descendants
+*   in one pass and remembers which nodes changed, so that the owners of the
+*   nodes can refresh only what depends on them.
+*/
+class TransformTree final
+{
+    public:
+        static constexpr size_t No_parent = SIZE_MAX;
+
+        TransformTree();
+
+        // The parent must already be in the tree
+        size_t add_node(size_t parent_id = No_parent, Vector2d local_position = Vector2d(), double local_angle = 0.0);
+        size_t get_nodes_count() const;
+
+        void set_local_position(size_t node_id, Vector2d position);
+        void set_local_angle(size_t node_id, double angle);
+        void move(size_t node_id, Vector2d offset);
+        void rotate(size_t node_id, double angle);
+
+        Vector2d get_local_position(size_t node_id) const;
+        double get_local_angle(size_t node_id) const;
+
+        bool is_dirty() const;
+        void update();
+
+        // Valid after update(): whether the world transform changed in the last update
+        bool is_changed(size_t node_id) const;
+
+        Vector2d get_world_position(size_t node_id) const;
+        double get_world_angle(size_t node_id) const;
+        Vector2d transform_point(size_t node_id, Vector2d local_point) const;
+
+    private:
+        struct TransformNode
+        {
+            size_t parent_id;
+
+            Vector2d local_position;
+            double local_angle;
+
+            Affine2d world_matrix;
+            double world_angle;
+
+            bool is_dirty;
+            bool is_changed;
+        };
+
+        std::vector<TransformNode> nodes_;
+        bool has_dirty_nodes_;
+
+        void mark_dirty(size_t node_id);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+*   Lock-free slot for one producer and one consumer. The producer fills the
+*   write buffer and publishes it, the consumer takes the latest published
+*   buffer. Neither side ever waits for the other: the third buffer is always
+*   free for whichever of them wants to swap next. Buffers are reused, so a
+*   value that keeps its capacity (vectors) does not allocate after warm-up.
+*/
+template<typename T>
+class TripleBuffer final
+{
+    public:
+        TripleBuffer():
+            buffers_(),
+            write_index_(0),
+            middle_index_(1),
+            read_index_(2)
+            {}
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        // Producer side
+        T &get_write_buffer()
+        {
+            return buffers_[write_index_];
+        }
+
+        void publish()
+        {
+            write_index_ = middle_index_.exchange(write_index_ | Fresh_bit_, std::memory_order_acq_rel) & Index_mask_;
+        }
+
+        // Consumer side: returns true if a new buffer was published since the last call
+        bool update()
+        {
+            if (!(middle_index_.load(std::memory_order_relaxed) & Fresh_bit_))
+                return false;
+
+            read_index_ = middle_index_.exchange(read_index_, std::memory_order_acq_rel) & Index_mask_;
+            return true;
+        }
+
+        const T &get_read_buffer() const
+        {
+            return buffers_[read_index_];
+        }
+
+    private:
+        std::array<T, 3> buffers_;
+
+        // Every index is touched by its own side only, apart from the middle one
+        alignas(64) uint8_t write_index_;
+        alignas(64) std::atomic<uint8_t> middle_index_;
+        alignas(64) uint8_t read_index_;
+
+        static constexpr uint8_t Index_mask_ = 0x3;
+        static constexpr uint8_t Fresh_bit_  = 0x4;
+};
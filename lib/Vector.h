@@ -1,35 +1,143 @@
 #pragma once
 
-struct Vector2d final
+#include <cmath>
+#include <type_traits>
+
+/*
+*   2D vector over a floating point type. Everything is defined in the header,
+*   so the arithmetic is inlined into the hot loops, and is constexpr except for
+*   the functions that need a square root. The layout is two packed coordinates,
+*   so arrays of vectors can be processed with SIMD.
+*/
+template<typename T>
+struct Vector2 final
 {
-    explicit Vector2d();
-    explicit Vector2d(double coords);
-    explicit Vector2d(double x_coord, double y_coord);
+    static_assert(std::is_floating_point_v<T>, "Vector2 needs a floating point type");
+
+    using value_type = T;
+
+    constexpr explicit Vector2():
+        Vector2(0, 0)
+        {}
+
+    constexpr explicit Vector2(T coords):
+        Vector2(coords, coords)
+        {}
+
+    constexpr explicit Vector2(T x_coord, T y_coord):
+        x(x_coord),
+        y(y_coord)
+        {}
+
+    // Converts between precisions, e.g. Vector2f(Vector2d(...))
+    template<typename U>
+    constexpr explicit Vector2(const Vector2<U> &other):
+        x(static_cast<T>(other.x)),
+        y(static_cast<T>(other.y))
+        {}
 
-    double x;
-    double y;
+    T x;
+    T y;
 
-    double dot(const Vector2d &other) const;
-    double norm_sq() const;
-    double norm() const;
+    constexpr T dot(const Vector2 &other) const
+    {
+        return x * other.x + y * other.y;
+    }
 
-    Vector2d &normalize();
+    constexpr T norm_sq() const
+    {
+        return dot(*this);
+    }
 
-    Vector2d normal() const;
+    T norm() const
+    {
+        return std::sqrt(norm_sq());
+    }
 
-    Vector2d &operator+=(const Vector2d &other);
-    Vector2d &operator-=(const Vector2d &other);
+    Vector2 &normalize()
+    {
+        return *this /= norm();
+    }
 
-    Vector2d &operator*=(double other);
-    Vector2d &operator/=(double other);
+    constexpr Vector2 normal() const
+    {
+        return Vector2(-y, x);
+    }
+
+    constexpr Vector2 &operator+=(const Vector2 &other)
+    {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
+
+    constexpr Vector2 &operator-=(const Vector2 &other)
+    {
+        x -= other.x;
+        y -= other.y;
+        return *this;
+    }
+
+    constexpr Vector2 &operator*=(T other)
+    {
+        x *= other;
+        y *= other;
+        return *this;
+    }
+
+    constexpr Vector2 &operator/=(T other)
+    {
+        return *this *= (1 / other);
+    }
 };
 
-Vector2d operator-(const Vector2d &vec);
+// The scalar of mixed operations is not deduced, so that vec * 2 works for any T
+template<typename T>
+using Scalar_t = std::type_identity_t<T>;
 
-Vector2d operator+(const Vector2d &lhs, const Vector2d &rhs);
-Vector2d operator-(const Vector2d &lhs, const Vector2d &rhs);
+template<typename T>
+constexpr Vector2<T> operator-(const Vector2<T> &vec)
+{
+    return Vector2<T>(-vec.x, -vec.y);
+}
+
+template<typename T>
+constexpr Vector2<T> operator+(const Vector2<T> &lhs, const Vector2<T> &rhs)
+{
+    Vector2<T> tmp = lhs;
+    return tmp += rhs;
+}
+
+template<typename T>
+constexpr Vector2<T> operator-(const Vector2<T> &lhs, const Vector2<T> &rhs)
+{
+    Vector2<T> tmp = lhs;
+    return tmp -= rhs;
+}
+
+template<typename T>
+constexpr Vector2<T> operator*(const Vector2<T> &vec, Scalar_t<T> factor)
+{
+    Vector2<T> tmp = vec;
+    return tmp *= factor;
+}
+
+template<typename T>
+constexpr Vector2<T> operator*(Scalar_t<T> factor, const Vector2<T> &vec)
+{
+    return vec * factor;
+}
+
+template<typename T>
+constexpr Vector2<T> operator/(const Vector2<T> &vec, Scalar_t<T> factor)
+{
+    Vector2<T> tmp = vec;
+    return tmp /= factor;
+}
 
-Vector2d operator*(const Vector2d &vec, double factor);
-Vector2d operator*(double factor, const Vector2d &vec);
+using Vector2d = Vector2<double>;
+using Vector2f = Vector2<float>;
 
-Vector2d operator/(const Vector2d &vec, double factor);
\ No newline at end of file
+static_assert(std::is_trivially_copyable_v<Vector2d> && std::is_trivially_copyable_v<Vector2f>);
+static_assert(sizeof(Vector2d) == 2 * sizeof(double) && sizeof(Vector2f) == 2 * sizeof(float));
+static_assert((Vector2d(1, 2) + Vector2d(3) * 2).dot(Vector2d(1, 0).normal()) == 8);
@@ -0,0 +1,257 @@
+#include <algorithm>
+
+#include "VectorEnvironment.h"
+
+VectorEnvironment::VectorEnvironment(const Config &config):
+    config_(config),
+    pool_(config.threads_count),
+    simulations_(),
+    episodes_(config.envs_count, 0),
+    spares_(),
+    spare_states_(config.envs_count),
+    spare_seeds_(config.envs_count),
+    prepared_seeds_(config.envs_count),
+    spares_requested_(false),
+    wake_count_(0),
+    stopping_(false),
+    spares_thread_()
+    {
+        // On the thread of the caller: a new Rocket draws its fire with std::rand, which is not thread-safe
+        for (size_t env_id = 0; env_id < config_.envs_count; ++env_id)
+        {
+            simulations_.push_back(std::make_unique<Simulation>(config_.world_width, config_.world_height));
+            spares_     .push_back(std::make_unique<Planet>(config_.world_width, config_.world_height));
+
+            spare_seeds_[env_id] = get_episode_seed(env_id, 0);
+            spare_states_[env_id].store(Spare_pending, std::memory_order_relaxed);
+        }
+
+        spares_thread_ = std::thread(&VectorEnvironment::spares_loop, this);
+        wake_spares_thread();
+    }
+
+VectorEnvironment::~VectorEnvironment()
+{
+    stopping_.store(true, std::memory_order_release);
+    wake_spares_thread();
+
+    spares_thread_.join();
+}
+
+const VectorEnvironment::Config &VectorEnvironment::get_config() const
+{
+    return config_;
+}
+
+void VectorEnvironment::reset(const Buffers &buffers)
+{
+    pool_.parallel_for(config_.envs_count, Envs_per_chunk_, [this, &buffers](size_t begin, size_t end, size_t)
+    {
+        for (size_t env_id = begin; env_id < end; ++env_id)
+        {
+            reset_env(env_id);
+            write_observation(env_id, buffers);
+
+            if (buffers.rewards)
+                buffers.rewards[env_id] = 0;
+            if (buffers.dones)
+                buffers.dones[env_id] = Done_running;
+        }
+    });
+
+    if (spares_requested_.exchange(false, std::memory_order_relaxed))
+        wake_spares_thread();
+}
+
+void VectorEnvironment::step(const uint32_t *actions, const Buffers &buffers)
+{
+    pool_.parallel_for(config_.envs_count, Envs_per_chunk_, [this, actions, &buffers](size_t begin, size_t end, size_t)
+    {
+        for (size_t env_id = begin; env_id < end; ++env_id)
+        {
+            apply_action(env_id, actions[env_id]);
+            simulations_[env_id]->step(config_.dt);
+            finish_step(env_id, buffers);
+        }
+    });
+
+    if (spares_requested_.exchange(false, std::memory_order_relaxed))
+        wake_spares_thread();
+}
+
+void VectorEnvironment::spares_loop()
+{
+    uint32_t seen_wake_count = 0;
+    while (true)
+    {
+        wake_count_.wait(seen_wake_count, std::memory_order_acquire);
+        seen_wake_count = wake_count_.load(std::memory_order_acquire);
+
+        if (stopping_.load(std::memory_order_acquire))
+            return;
+
+        for (size_t env_id = 0; env_id < config_.envs_count && !stopping_.load(std::memory_order_relaxed); ++env_id)
+        {
+            if (spare_states_[env_id].load(std::memory_order_acquire) != Spare_pending)
+                continue;
+
+            // Only reads the world size of the simulation, which never changes
+            uint32_t seed = spare_seeds_[env_id];
+            simulations_[env_id]->generate_planet(*spares_[env_id], seed);
+            if (config_.render_frames)
+                spares_[env_id]->prepare_background();
+
+            prepared_seeds_[env_id] = seed;
+            spare_states_[env_id].store(Spare_ready, std::memory_order_release);
+        }
+    }
+}
+
+void VectorEnvironment::wake_spares_thread()
+{
+    wake_count_.fetch_add(1, std::memory_order_release);
+    wake_count_.notify_one();
+}
+
+// Every episode of every environment gets its own seed
+uint32_t VectorEnvironment::get_episode_seed(size_t env_id, uint32_t episode) const
+{
+    return config_.seed + static_cast<uint32_t>(episode * config_.envs_count + env_id);
+}
+
+void VectorEnvironment::reset_env(size_t env_id)
+{
+    uint32_t seed = get_episode_seed(env_id, episodes_[env_id]);
+    ++episodes_[env_id];
+
+    // A pending spare is being made by the background thread, it can't be touched
+    if (spare_states_[env_id].load(std::memory_order_acquire) != Spare_ready)
+    {
+        simulations_[env_id]->restart(seed);
+        return;
+    }
+
+    // The spare is for another episode if the last reset did not wait for it
+    if (prepared_seeds_[env_id] == seed)
+        simulations_[env_id]->restart(seed, *spares_[env_id]);
+    else
+        simulations_[env_id]->restart(seed);
+
+    spare_seeds_[env_id] = get_episode_seed(env_id, episodes_[env_id]);
+    spare_states_[env_id].store(Spare_pending, std::memory_order_release);
+    spares_requested_.store(true, std::memory_order_relaxed);
+}
+
+void VectorEnvironment::apply_action(size_t env_id, uint32_t action)
+{
+    Rocket &rocket = simulations_[env_id]->get_rocket();
+
+    if (action & Action_increase_thrust)
+        rocket.toggle_engine(Rocket::EngineMode::INCREASE_THRUST);
+    else if (action & Action_decrease_thrust)
+        rocket.toggle_engine(Rocket::EngineMode::DECREASE_THRUST);
+    else
+        rocket.toggle_engine(Rocket::EngineMode::IDLE);
+
+    if (action & Action_rotate_ccw)
+        rocket.toggle_rcs(Rocket::RcsEngineMode::CCW);
+    else if (action & Action_rotate_cw)
+        rocket.toggle_rcs(Rocket::RcsEngineMode::CW);
+    else if (action & Action_stabilize)
+        rocket.toggle_rcs(Rocket::RcsEngineMode::STABILIZE);
+    else
+        rocket.toggle_rcs(Rocket::RcsEngineMode::IDLE);
+}
+
+void VectorEnvironment::finish_step(size_t env_id, const Buffers &buffers)
+{
+    const Simulation &simulation = *simulations_[env_id];
+
+    float reward = 0;
+    uint8_t done = Done_running;
+    switch (simulation.get_rocket().get_state())
+    {
+        case Rocket::RocketState::LANDED:
+        {
+            reward = Landed_reward;
+            done = Done_terminated;
+            break;
+        }
+        case Rocket::RocketState::CRASHED:
+        {
+            reward = Crashed_reward;
+            done = Done_terminated;
+            break;
+        }
+        case Rocket::RocketState::IN_FLIGHT:
+        {
+            if (simulation.is_rocket_outside())
+            {
+                reward = Crashed_reward;
+                done = Done_terminated;
+            }
+            else if (simulation.get_steps_count() >= config_.max_steps)
+            {
+                done = Done_truncated;
+            }
+            break;
+        }
+    }
+
+    if (buffers.rewards)
+        buffers.rewards[env_id] = reward;
+    if (buffers.dones)
+        buffers.dones[env_id] = done;
+
+    if (done != Done_running)
+        reset_env(env_id);
+
+    write_observation(env_id, buffers);
+}
+
+void VectorEnvironment::write_observation(size_t env_id, const Buffers &buffers)
+{
+    Simulation &simulation = *simulations_[env_id];
+    const Rocket &rocket = simulation.get_rocket();
+    const Planet &planet = simulation.get_planet();
+
+    if (buffers.states)
+    {
+        Vector2d position = rocket.get_position();
+        Vector2d velocity = rocket.get_velocity();
+        uint32_t ground_x = std::clamp(position.x, 0.0, static_cast<double>(config_.world_width - 1));
+
+        float *state = buffers.states + env_id * State_size;
+        state[0] = position.x;
+        state[1] = position.y;
+        state[2] = velocity.x;
+        state[3] = velocity.y;
+        state[4] = rocket.get_angle();
+        state[5] = rocket.get_rotation_speed();
+        state[6] = rocket.get_thrust();
+        state[7] = rocket.get_fuel();
+        state[8] = rocket.get_hydrazine();
+        state[9] = planet.get_ground_height(ground_x) - position.y;
+    }
+
+    if (buffers.heightmaps && config_.heightmap_size > 0)
+    {
+        float *heightmap = buffers.heightmaps + env_id * config_.heightmap_size;
+        for (size_t sample = 0; sample < config_.heightmap_size; ++sample)
+        {
+            uint32_t x = (2 * sample + 1) * config_.world_width / (2 * config_.heightmap_size);
+            heightmap[sample] = static_cast<float>(planet.get_ground_height(x)) / config_.world_height;
+        }
+    }
+
+    if (buffers.frames && config_.render_frames)
+    {
+        const size_t width  = config_.world_width;
+        const size_t height = config_.world_height;
+        uint32_t *frame = buffers.frames + env_id * width * height;
+
+        // The opaque background covers the whole frame, so the previous content does not matter
+        simulation.get_planet().draw(frame, width, height);
+        simulation.get_rocket().draw(frame, width, height);
+    }
+}
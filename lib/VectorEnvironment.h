@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Simulation.h"
+#include "WorkStealingPool.h"
+
+/*
+*   Many independent landing environments stepped together for training
+*   controllers. Every environment is a Simulation with its own planet.
+*   step() applies one action per environment, advances all of them on the
+*   thread pool and writes the observations straight into the buffers of the
+*   caller, environment i at offset i * (size of one observation).
+*
+*   A finished environment is reset inside the same step: its reward and done
+*   flag belong to the finished episode, its observation already to the next
+*   one. Every environment has a spare planet that a background thread
+*   generates ahead for its next episode, so a reset is a swap and the batch
+*   does not wait for a new planet. Only when episodes end faster than the
+*   spares are made is the planet generated inline. Either way the episode
+*   gets the same planet, so the results do not depend on the timing.
+*/
+class VectorEnvironment final
+{
+    public:
+        struct Config
+        {
+            size_t envs_count;
+            size_t threads_count;
+            uint32_t seed;
+            float dt;
+            size_t max_steps;
+
+            // At least Min_world_width by Min_world_height
+            size_t world_width;
+            size_t world_height;
+
+            // Optional observations: the whole rendered frame and the ground height sampled across the world
+            bool render_frames;
+            size_t heightmap_size;
+        };
+
+        // Null buffers are not written
+        struct Buffers
+        {
+            float    *states;     // envs_count * State_size
+            uint32_t *frames;     // envs_count * world_width * world_height pixels
+            float    *heightmaps; // envs_count * heightmap_size, ground y divided by world height
+            float    *rewards;    // envs_count
+            uint8_t  *dones;      // envs_count, one of Done
+        };
+
+        // Bits of an action, the keys a player would hold
+        enum Action : uint32_t
+        {
+            Action_increase_thrust = 1 << 0,
+            Action_decrease_thrust = 1 << 1,
+            Action_rotate_ccw      = 1 << 2,
+            Action_rotate_cw       = 1 << 3,
+            Action_stabilize       = 1 << 4
+        };
+
+        enum Done : uint8_t
+        {
+            Done_running    = 0,
+            Done_terminated = 1, // landed, crashed or left the world
+            Done_truncated  = 2  // max_steps passed
+        };
+
+        /*
+        *   x, y, velocity x, velocity y, angle, rotation speed,
+        *   thrust, fuel, hydrazine, height above the ground under the rocket
+        */
+        static constexpr size_t State_size = 10;
+
+        // Smaller worlds have no room for the three landing areas of Planet::generate_landscape
+        static constexpr size_t Min_world_width  = 256;
+        static constexpr size_t Min_world_height = 256;
+
+        static constexpr float Landed_reward  =  1;
+        static constexpr float Crashed_reward = -1;
+
+        explicit VectorEnvironment(const Config &config);
+        ~VectorEnvironment();
+
+        VectorEnvironment(const VectorEnvironment &) = delete;
+        VectorEnvironment &operator=(const VectorEnvironment &) = delete;
+
+        const Config &get_config() const;
+
+        // Starts a new episode in every environment
+        void reset(const Buffers &buffers);
+
+        // actions has envs_count elements, each a combination of Action bits
+        void step(const uint32_t *actions, const Buffers &buffers);
+
+    private:
+        Config config_;
+        WorkStealingPool pool_;
+        std::vector<std::unique_ptr<Simulation>> simulations_;
+        std::vector<uint32_t> episodes_;
+
+        /*
+        *   A pending spare belongs to the background thread, which generates it
+        *   from spare_seeds_ and makes it ready. A ready spare belongs to the
+        *   stepping threads, prepared_seeds_ tells which episode it is for.
+        */
+        enum SpareState : uint8_t
+        {
+            Spare_pending,
+            Spare_ready
+        };
+
+        std::vector<std::unique_ptr<Planet>> spares_;
+        std::vector<std::atomic<uint8_t>> spare_states_;
+        std::vector<uint32_t> spare_seeds_;
+        std::vector<uint32_t> prepared_seeds_;
+
+        // Set by the resets of a step, the background thread is woken once after the step
+        std::atomic<bool> spares_requested_;
+
+        // Bumped for new spare requests and by the destructor, the background thread sleeps on it
+        std::atomic<uint32_t> wake_count_;
+        std::atomic<bool> stopping_;
+        std::thread spares_thread_;
+
+        void spares_loop();
+        void wake_spares_thread();
+
+        uint32_t get_episode_seed(size_t env_id, uint32_t episode) const;
+        void reset_env(size_t env_id);
+        void apply_action(size_t env_id, uint32_t action);
+        void finish_step(size_t env_id, const Buffers &buffers);
+        void write_observation(size_t env_id, const Buffers &buffers);
+
+        static constexpr size_t Envs_per_chunk_ = 8;
+};
@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(size_t threads_count):
+    queues_(),
+    threads_(),
+    job_mutex_(),
+    job_started_(),
+    job_finished_(),
+    task_(nullptr),
+    job_id_(0),
+    workers_done_(0),
+    stopping_(false)
+    {
+        threads_count = std::max<size_t>(threads_count, 1);
+        for (size_t worker_id = 0; worker_id < threads_count; ++worker_id)
+            queues_.push_back(std::make_unique<WorkerQueue>());
+
+        // Worker 0 is the thread calling parallel_for
+        for (size_t worker_id = 1; worker_id < threads_count; ++worker_id)
+            threads_.emplace_back(&WorkStealingPool::worker_loop, this, worker_id);
+    }
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        stopping_ = true;
+    }
+    job_started_.notify_all();
+
+    for (std::thread &thread : threads_)
+        thread.join();
+}
+
+size_t WorkStealingPool::get_threads_count() const
+{
+    return queues_.size();
+}
+
+size_t WorkStealingPool::get_default_threads_count()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkStealingPool::parallel_for(size_t count, size_t chunk_size, const Task &task)
+{
+    if (count == 0)
+        return;
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const size_t chunks_count  = (count + chunk_size - 1) / chunk_size;
+    const size_t workers_count = get_threads_count();
+
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        for (size_t worker_id = 0; worker_id < workers_count; ++worker_id)
+        {
+            WorkerQueue &queue = *queues_[worker_id];
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+
+            // Neighbouring chunks go to the same worker
+            size_t first_chunk = chunks_count *  worker_id      / workers_count;
+            size_t last_chunk  = chunks_count * (worker_id + 1) / workers_count;
+            for (size_t chunk_id = first_chunk; chunk_id < last_chunk; ++chunk_id)
+                queue.chunks.emplace_back(chunk_id * chunk_size, std::min(count, (chunk_id + 1) * chunk_size));
+        }
+
+        task_ = &task;
+        workers_done_ = 0;
+        ++job_id_;
+    }
+    job_started_.notify_all();
+
+    run_chunks(0, task);
+
+    // Every worker has to be done with this job before the task goes out of scope
+    std::unique_lock<std::mutex> lock(job_mutex_);
+    job_finished_.wait(lock, [this] { return workers_done_ == threads_.size(); });
+    task_ = nullptr;
+}
+
+void WorkStealingPool::worker_loop(size_t worker_id)
+{
+    size_t seen_job_id = 0;
+    for (;;)
+    {
+        const Task *task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex_);
+            job_started_.wait(lock, [this, seen_job_id] { return stopping_ || job_id_ != seen_job_id; });
+            if (stopping_)
+                return;
+
+            seen_job_id = job_id_;
+            task = task_;
+        }
+
+        run_chunks(worker_id, *task);
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            ++workers_done_;
+        }
+        job_finished_.notify_one();
+    }
+}
+
+// Chunks are only added before the job starts, so once there is nothing to steal the worker is done
+void WorkStealingPool::run_chunks(size_t worker_id, const Task &task)
+{
+    Chunk chunk;
+    while (pop_own(worker_id, chunk) || steal(worker_id, chunk))
+        task(chunk.first, chunk.second, worker_id);
+}
+
+bool WorkStealingPool::pop_own(size_t worker_id, Chunk &chunk)
+{
+    WorkerQueue &queue = *queues_[worker_id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty())
+        return false;
+
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+// Victims are tried starting from the next worker, so thieves spread over different queues
+bool WorkStealingPool::steal(size_t worker_id, Chunk &chunk)
+{
+    const size_t workers_count = get_threads_count();
+    for (size_t shift = 1; shift < workers_count; ++shift)
+    {
+        WorkerQueue &queue = *queues_[(worker_id + shift) % workers_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.chunks.empty())
+            continue;
+
+        chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+*   Fixed set of threads running index ranges. parallel_for cuts [0, count)
+*   into chunks and deals them out to the workers in contiguous blocks. A
+*   worker takes its own chunks from the front of its deque; once it runs out,
+*   it steals from the back of the other deques, so uneven chunks (episodes
+*   of different length) do not leave threads idle. The calling thread is
+*   worker 0 and works too.
+*/
+class WorkStealingPool final
+{
+    public:
+        // Runs task(begin, end, worker_id) for a chunk [begin, end)
+        using Task = std::function<void(size_t begin, size_t end, size_t worker_id)>;
+
+        explicit WorkStealingPool(size_t threads_count = get_default_threads_count());
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        size_t get_threads_count() const;
+
+        // Blocks until every chunk is done
+        void parallel_for(size_t count, size_t chunk_size, const Task &task);
+
+        static size_t get_default_threads_count();
+
+    private:
+        using Chunk = std::pair<size_t, size_t>;
+
+        // Padded to a cache line, so that the locks of neighbours do not share one
+        struct alignas(64) WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> threads_;
+
+        // Current job, guarded by job_mutex_
+        std::mutex job_mutex_;
+        std::condition_variable job_started_;
+        std::condition_variable job_finished_;
+        const Task *task_;
+        size_t job_id_;
+        size_t workers_done_;
+        bool stopping_;
+
+        void worker_loop(size_t worker_id);
+        void run_chunks(size_t worker_id, const Task &task);
+
+        bool pop_own(size_t worker_id, Chunk &chunk);
+        bool steal(size_t worker_id, Chunk &chunk);
+};
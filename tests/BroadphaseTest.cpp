@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Broadphase.h"
+
+/*
+*   Sweep and prune and the spatial hash against all pairs checked one by one.
+*   Boxes drift a little every step, like bodies between frames, and proxies
+*   are added and removed on the way. Coordinates are snapped to a coarse grid
+*   now and then, so boxes touching by an edge are tested too.
+*/
+
+namespace
+{
+    constexpr size_t Steps_count      = 500;
+    constexpr size_t Proxies_count    = 300;
+    constexpr size_t Proxies_per_body = 3;
+    constexpr double World_size       = 1000;
+    constexpr double Max_box_size     = 60;
+    constexpr double Max_speed        = 4;
+    constexpr double Cell_size        = 50;
+
+    struct TestProxy
+    {
+        uint32_t id = 0;
+        uint32_t body_id = 0;
+        AABB box;
+        double vx = 0;
+        double vy = 0;
+    };
+
+    using Pairs = std::vector<Broadphase::ProxyPair>;
+
+    Pairs find_brute_force_pairs(const std::vector<TestProxy> &proxies)
+    {
+        Pairs pairs;
+        for (size_t i = 0; i < proxies.size(); ++i)
+        {
+            for (size_t j = i + 1; j < proxies.size(); ++j)
+            {
+                const TestProxy &first  = proxies[i];
+                const TestProxy &second = proxies[j];
+                if (first.body_id == second.body_id || !first.box.is_intersect(second.box))
+                    continue;
+
+                pairs.emplace_back(std::min(first.id, second.id), std::max(first.id, second.id));
+            }
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    bool check_pairs(Broadphase &broadphase, const Pairs &expected, const char *name, size_t step)
+    {
+        Pairs pairs;
+        broadphase.find_pairs(pairs);
+
+        for (const Broadphase::ProxyPair &pair : pairs)
+        {
+            if (pair.first >= pair.second)
+            {
+                std::cerr << name << ", step " << step << ": pair (" << pair.first << ", " << pair.second
+                          << ") is not ordered\n";
+                return false;
+            }
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+        if (std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end())
+        {
+            std::cerr << name << ", step " << step << ": a pair is reported twice\n";
+            return false;
+        }
+
+        if (pairs != expected)
+        {
+            std::cerr << name << ", step " << step << ": " << pairs.size() << " pairs, expected "
+                      << expected.size() << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    AABB make_box(std::mt19937 &random, bool is_snapped)
+    {
+        std::uniform_real_distribution<double> position(0, World_size);
+        std::uniform_real_distribution<double> size(1, Max_box_size);
+
+        double left   = position(random);
+        double bottom = position(random);
+        double width  = size(random);
+        double height = size(random);
+        if (is_snapped)
+        {
+            left   = std::round(left   / 10) * 10;
+            bottom = std::round(bottom / 10) * 10;
+            width  = std::round(width  / 10) * 10 + 10;
+            height = std::round(height / 10) * 10 + 10;
+        }
+        // y goes up, top is above bottom
+        return AABB(left, left + width, bottom + height, bottom);
+    }
+
+    void add_proxy(std::vector<TestProxy> &proxies, std::vector<Broadphase *> &broadphases,
+                   std::mt19937 &random, uint32_t body_id)
+    {
+        std::uniform_real_distribution<double> speed(-Max_speed, Max_speed);
+
+        TestProxy proxy;
+        proxy.body_id = body_id;
+        proxy.box = make_box(random, random() % 4 == 0);
+        proxy.vx = speed(random);
+        proxy.vy = speed(random);
+
+        proxy.id = broadphases.front()->add_proxy(proxy.box, body_id);
+        for (size_t i = 1; i < broadphases.size(); ++i)
+            broadphases[i]->add_proxy(proxy.box, body_id);
+
+        proxies.push_back(proxy);
+    }
+}
+
+int main()
+{
+    SweepAndPrune sweep_and_prune;
+    SpatialHash spatial_hash(Cell_size);
+    std::vector<Broadphase *> broadphases = { &sweep_and_prune, &spatial_hash };
+
+    std::mt19937 random(1);
+    std::vector<TestProxy> proxies;
+    for (size_t i = 0; i < Proxies_count; ++i)
+        add_proxy(proxies, broadphases, random, static_cast<uint32_t>(i / Proxies_per_body));
+    uint32_t next_body_id = Proxies_count;
+
+    size_t pairs_count = 0;
+    for (size_t step = 0; step < Steps_count; ++step)
+    {
+        bool is_snapped = step % 50 < 5;
+        for (TestProxy &proxy : proxies)
+        {
+            proxy.box.left   += proxy.vx;
+            proxy.box.right  += proxy.vx;
+            proxy.box.top    += proxy.vy;
+            proxy.box.bottom += proxy.vy;
+            if (is_snapped)
+            {
+                proxy.box.left   = std::round(proxy.box.left);
+                proxy.box.right  = std::round(proxy.box.right);
+                proxy.box.top    = std::round(proxy.box.top);
+                proxy.box.bottom = std::round(proxy.box.bottom);
+            }
+
+            // Keep the boxes around the world, bouncing them off its borders
+            if (proxy.box.left < 0 || proxy.box.right > World_size)
+                proxy.vx = -proxy.vx;
+            if (proxy.box.bottom < 0 || proxy.box.top > World_size)
+                proxy.vy = -proxy.vy;
+
+            for (Broadphase *broadphase : broadphases)
+                broadphase->update_proxy(proxy.id, proxy.box);
+        }
+
+        if (step % 10 == 0)
+        {
+            size_t removed_id = random() % proxies.size();
+            for (Broadphase *broadphase : broadphases)
+                broadphase->remove_proxy(proxies[removed_id].id);
+            proxies.erase(proxies.begin() + removed_id);
+
+            // Reuses the freed proxy id
+            add_proxy(proxies, broadphases, random, next_body_id++);
+        }
+
+        Pairs expected = find_brute_force_pairs(proxies);
+        pairs_count += expected.size();
+
+        if (!check_pairs(sweep_and_prune, expected, "SweepAndPrune", step) ||
+            !check_pairs(spatial_hash   , expected, "SpatialHash"  , step))
+            return EXIT_FAILURE;
+    }
+
+    std::cout << "Broadphases match brute force in " << Steps_count << " steps, "
+              << pairs_count / Steps_count << " pairs per step\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "CapsuleCollider.h"
+#include "CircleCollider.h"
+#include "Landscape.h"
+#include "RectCollider.h"
+
+/*
+*   Landscape::check_collisions, the segment BVH and the batched SAT of
+*   Narrowphase, against every collider checked with every segment one by one
+*   by the scalar SAT of SAT.h. Colliders of all four shapes are thrown around
+*   a random height map with an overhang, the contacts have to be the same
+*   pairs with the same normals and MTVs. Built twice, with 2 lanes and with
+*   4 (AVX).
+*/
+
+namespace
+{
+    constexpr size_t Rounds_count    = 200;
+    constexpr size_t Colliders_count = 400;
+    constexpr double World_width     = 2000;
+    constexpr double Max_size        = 60;
+
+    // The batch scales axes by the inverse length where SAT.h divides, the last bits may differ
+    constexpr double Tolerance = 1e-9;
+
+    // Exit code for a test ctest should report as skipped
+    constexpr int Skip_code = 77;
+
+    struct Terrain
+    {
+        Landscape landscape;
+
+        // Same order as in the landscape: the height map first, then the polyline
+        std::vector<Segment> segments;
+    };
+
+    void build_terrain(std::mt19937 &random, Terrain &terrain)
+    {
+        std::uniform_int_distribution<uint32_t> step(8, 48);
+        std::uniform_int_distribution<uint32_t> height(400, 700);
+
+        std::vector<Vector2d> points;
+        for (uint32_t x = 0; x <= World_width; x += step(random))
+        {
+            uint32_t y = height(random);
+            terrain.landscape.add_point(x, y);
+            points.emplace_back(x, y);
+        }
+        for (size_t i = 0; i + 1 < points.size(); ++i)
+            terrain.segments.emplace_back(points[i], points[i + 1]);
+
+        // An overhang above the middle of the ground
+        std::vector<Vector2d> polyline = { Vector2d(900, 350), Vector2d(1000, 330), Vector2d(1100, 360), Vector2d(1150, 340) };
+        terrain.landscape.add_polyline(polyline);
+        for (size_t i = 0; i + 1 < polyline.size(); ++i)
+            terrain.segments.emplace_back(polyline[i], polyline[i + 1]);
+
+        terrain.landscape.compile();
+    }
+
+    ShapeCollider make_collider(std::mt19937 &random)
+    {
+        std::uniform_real_distribution<double> x(0, World_width);
+        std::uniform_real_distribution<double> y(280, 760);
+        std::uniform_real_distribution<double> size(2, Max_size);
+        std::uniform_real_distribution<double> angle(-4, 4);
+
+        Vector2d position(x(random), y(random));
+        switch (random() % 5)
+        {
+            case 0:
+            {
+                Vector2d rect_size(size(random), size(random));
+                return RectCollider(rect_size, position, rect_size / 2, angle(random));
+            }
+            case 1:
+            {
+                TriangleCollider::polygon_t vertices = { Vector2d(-size(random), 0), Vector2d(0, -size(random)),
+                                                         Vector2d(size(random), size(random) / 4) };
+                return TriangleCollider(vertices, 0, position, Vector2d(), angle(random));
+            }
+            case 2:
+            {
+                // Rounded triangle
+                TriangleCollider::polygon_t vertices = { Vector2d(-size(random), 0), Vector2d(0, -size(random)),
+                                                         Vector2d(size(random), size(random) / 4) };
+                return TriangleCollider(vertices, size(random) / 8, position, Vector2d(), angle(random));
+            }
+            case 3:
+            {
+                return CircleCollider(size(random) / 2, position);
+            }
+            default:
+            {
+                return CapsuleCollider(size(random), size(random) / 4, position, Vector2d(), angle(random));
+            }
+        }
+    }
+
+    // Every pair checked by ConvexCollider::check_collision, the mtv pushes out to the free side
+    std::vector<Contact> find_scalar_contacts(const std::vector<ShapeCollider> &colliders, const std::vector<Segment> &segments)
+    {
+        std::vector<Contact> contacts;
+        for (uint32_t collider_id = 0; collider_id < colliders.size(); ++collider_id)
+        {
+            for (uint32_t segment_id = 0; segment_id < segments.size(); ++segment_id)
+            {
+                const Segment &segment = segments[segment_id];
+                auto [is_colliding, mtv] = colliders[collider_id].check_collision(segment);
+                if (!is_colliding)
+                    continue;
+
+                double dx = segment.b_x - segment.a_x;
+                double dy = segment.b_y - segment.a_y;
+                double length = std::sqrt(dx * dx + dy * dy);
+                Vector2d normal(dy / length, -dx / length);
+                if (mtv.dot(normal) < 0)
+                    mtv = -mtv;
+
+                contacts.push_back({collider_id, segment_id, {mtv, normal}, segment});
+            }
+        }
+        return contacts;
+    }
+
+    bool is_near(Vector2d actual, Vector2d expected)
+    {
+        double scale = std::max(1.0, expected.norm());
+        return (actual - expected).norm() <= Tolerance * scale;
+    }
+
+    bool is_same_segment(const Segment &actual, const Segment &expected)
+    {
+        return actual.a_x == expected.a_x && actual.a_y == expected.a_y &&
+               actual.b_x == expected.b_x && actual.b_y == expected.b_y;
+    }
+
+    bool compare(std::vector<Contact> contacts, const std::vector<Contact> &expected, size_t round)
+    {
+        // The batch goes through the BVH candidates, the scalar check through all segments in order
+        std::sort(contacts.begin(), contacts.end(), [](const Contact &lhs, const Contact &rhs)
+        {
+            return lhs.collider_id != rhs.collider_id ? lhs.collider_id < rhs.collider_id : lhs.segment_id < rhs.segment_id;
+        });
+
+        if (contacts.size() != expected.size())
+        {
+            std::cerr << "round " << round << ": " << contacts.size() << " contacts, expected " << expected.size() << '\n';
+            return false;
+        }
+
+        for (size_t i = 0; i < contacts.size(); ++i)
+        {
+            const Contact &actual = contacts[i];
+            const Contact &reference = expected[i];
+            if (actual.collider_id != reference.collider_id || actual.segment_id != reference.segment_id)
+            {
+                std::cerr << "round " << round << ": contact (" << actual.collider_id << ", " << actual.segment_id
+                          << "), expected (" << reference.collider_id << ", " << reference.segment_id << ")\n";
+                return false;
+            }
+
+            if (!is_same_segment(actual.segment, reference.segment) || !is_near(actual.info.normal, reference.info.normal) ||
+                !is_near(actual.info.mtv, reference.info.mtv))
+            {
+                std::cerr << "round " << round << ", collider " << actual.collider_id << ", segment " << actual.segment_id
+                          << ": mtv (" << actual.info.mtv.x << ", " << actual.info.mtv.y << "), expected ("
+                          << reference.info.mtv.x << ", " << reference.info.mtv.y << ")\n";
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+#ifdef __AVX__
+    if (!__builtin_cpu_supports("avx"))
+    {
+        std::cout << "No AVX on this CPU, skipped\n";
+        return Skip_code;
+    }
+#endif
+
+    std::cerr.precision(17);
+
+    std::mt19937 random(1);
+    Terrain terrain;
+    build_terrain(random, terrain);
+
+    size_t contacts_count = 0;
+    std::vector<ShapeCollider> colliders;
+    std::vector<Contact> contacts;
+    for (size_t round = 0; round < Rounds_count; ++round)
+    {
+        colliders.clear();
+        for (size_t i = 0; i < Colliders_count; ++i)
+            colliders.push_back(make_collider(random));
+
+        terrain.landscape.check_collisions(colliders, contacts);
+        std::vector<Contact> expected = find_scalar_contacts(colliders, terrain.segments);
+        contacts_count += expected.size();
+
+        if (!compare(contacts, expected, round))
+            return EXIT_FAILURE;
+    }
+
+    std::cout << "Narrowphase with " << Narrowphase::Lanes_count << " lanes matches the scalar SAT, "
+              << contacts_count / Rounds_count << " contacts per round\n";
+    return EXIT_SUCCESS;
+}
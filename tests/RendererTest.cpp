@@ -0,0 +1,135 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ProgressBar.h"
+#include "RenderBackend.h"
+#include "Simulation.h"
+#include "TileRenderer.h"
+
+/*
+*   TileRenderer against SerialRenderer on frames like the ones of the game:
+*   the planet, the rocket at random poses, the fuel bar, a semi-transparent
+*   sprite and fills, one of them blended. Frames are drawn only inside a few
+*   random damage areas that overlap each other, with several thread counts
+*   and tile shapes. The buffers have to be equal to the bit, the pixels
+*   outside the areas included.
+*/
+
+namespace
+{
+    constexpr size_t Width  = 1024;
+    constexpr size_t Height = 768;
+    constexpr size_t Frames_count = 40;
+
+    struct TileShape
+    {
+        size_t threads_count;
+        size_t tile_height;
+        size_t tile_width;
+    };
+
+    constexpr TileShape Tile_shapes[] = {
+        { 1, TileRenderer::Default_tile_height, 0 },
+        { 2, TileRenderer::Default_tile_height, 0 },
+        { 4, 16 , 0   },
+        { 3, 40 , 100 },
+        { 8, 1  , 0   },
+        { 4, 64 , 64  },
+        { 5, 7  , 13  },
+    };
+
+    std::vector<ScreenRect> make_areas(std::mt19937 &random, size_t frame)
+    {
+        // Every few frames the whole screen, like after a restart
+        if (frame % 7 == 0)
+            return { ScreenRect(0, 0, Width, Height) };
+
+        std::vector<ScreenRect> areas;
+        size_t areas_count = 1 + random() % 4;
+        for (size_t i = 0; i < areas_count; ++i)
+        {
+            int left = random() % Width;
+            int top  = random() % Height;
+            areas.push_back(ScreenRect(left, top, left + random() % 400, top + random() % 400));
+        }
+
+        // Overlaps the first one
+        ScreenRect first = areas.front();
+        areas.push_back(ScreenRect(first.left + 10, first.top + 10, first.right + 50, first.bottom + 50));
+        return areas;
+    }
+}
+
+int main()
+{
+    Simulation simulation(Width, Height, 3);
+    Rocket &rocket = simulation.get_rocket();
+    Planet &planet = simulation.get_planet();
+
+    ProgressBar fuel_bar(Sprite(RectTexture(Color(0, 0, 0, 0), 20, 20)), Vector2d(Width - 105, 5), Vector2d(100, 20),
+                         Color::White, Color::Red, 1);
+    Sprite glass(RectTexture(Color(255, 0, 0, 128), 60, 40));
+    glass.enable_rotation_cache();
+
+    SerialRenderer serial;
+    std::vector<std::unique_ptr<TileRenderer>> tile_renderers;
+    for (const TileShape &shape : Tile_shapes)
+        tile_renderers.push_back(std::make_unique<TileRenderer>(Width, Height, shape.threads_count, shape.tile_height, shape.tile_width));
+
+    std::vector<uint32_t> expected(Width * Height);
+    std::vector<uint32_t> actual(Width * Height);
+
+    std::mt19937 random(1);
+    size_t commands_count = 0;
+    for (size_t frame = 0; frame < Frames_count; ++frame)
+    {
+        rocket.set_position(Vector2d(random() % Width, random() % Height));
+        rocket.set_angle((random() % 700) / 100.0);
+        glass.set_position(random() % Width, random() % Height);
+        glass.set_angle((random() % 700) / 100.0);
+        fuel_bar.set_progress((random() % 130) / 100.0);
+
+        int fill_left = random() % Width;
+        int fill_top  = random() % Height;
+        ScreenRect fill(fill_left, fill_top, fill_left + random() % 300, fill_top + random() % 300);
+        ScreenRect shade(fill.right - 20, fill.top, fill.right + 80, fill.bottom + 40);
+
+        std::vector<ScreenRect> areas = make_areas(random, frame);
+
+        RenderQueue queue(Width, Height);
+        fuel_bar.submit(queue, 3);
+        glass.submit(queue, 2);
+        queue.add_fill(fill, Color::Yellow, 2);
+        rocket.submit(queue, 1);
+        planet.submit(queue, 0);
+        queue.add_fill(shade, Color(0, 0, 255, 100), 2, RenderCommand::BlendMode::ALPHA);
+        queue.prepare(areas);
+        commands_count += queue.get_commands().size();
+
+        // Pixels outside the areas keep whatever was in the buffer
+        uint32_t background = random();
+        std::fill(expected.begin(), expected.end(), background);
+        serial.render(queue, expected.data(), areas);
+
+        for (size_t shape_id = 0; shape_id < tile_renderers.size(); ++shape_id)
+        {
+            std::fill(actual.begin(), actual.end(), background);
+            tile_renderers[shape_id]->render(queue, actual.data(), areas);
+            if (std::memcmp(actual.data(), expected.data(), actual.size() * sizeof(uint32_t)) != 0)
+            {
+                const TileShape &shape = Tile_shapes[shape_id];
+                std::cerr << "frame " << frame << ": " << shape.threads_count << " threads, tiles "
+                          << shape.tile_width << 'x' << shape.tile_height << " differ from SerialRenderer\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::cout << "TileRenderer matches SerialRenderer in " << Frames_count << " frames, "
+              << commands_count / Frames_count << " commands per frame\n";
+    return EXIT_SUCCESS;
+}
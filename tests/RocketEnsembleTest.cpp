@@ -0,0 +1,168 @@
+#include <bit>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "RocketEnsemble.h"
+
+/*
+*   Every lane of RocketEnsemble against a scalar Rocket flown with the same
+*   random dt and random engine and RCS input. All fields have to be equal to
+*   the bit. The lander count is not a multiple of the lanes, so the padding
+*   lanes are exercised as well. Built twice, with 2 lanes and with 4 (AVX).
+*/
+
+namespace
+{
+    constexpr size_t Landers_count = 13;
+    constexpr size_t Steps_count   = 20000;
+    constexpr double Min_dt        = 0.001;
+    constexpr double Max_dt        = 0.05;
+
+    // Exit code for a test ctest should report as skipped
+    constexpr int Skip_code = 77;
+
+    bool is_equal(double first, double second)
+    {
+        return std::bit_cast<uint64_t>(first) == std::bit_cast<uint64_t>(second);
+    }
+
+    bool compare(const Rocket &rocket, const RocketEnsemble &ensemble, size_t lander_id, size_t step)
+    {
+        struct Field
+        {
+            const char *name;
+            double expected;
+            double actual;
+        };
+
+        const Field fields[] = {
+            { "position.x"    , rocket.get_position().x  , ensemble.get_position(lander_id).x   },
+            { "position.y"    , rocket.get_position().y  , ensemble.get_position(lander_id).y   },
+            { "velocity.x"    , rocket.get_velocity().x  , ensemble.get_velocity(lander_id).x   },
+            { "velocity.y"    , rocket.get_velocity().y  , ensemble.get_velocity(lander_id).y   },
+            { "angle"         , rocket.get_angle()       , ensemble.get_angle(lander_id)        },
+            { "rotation speed", rocket.get_rotation_speed(), ensemble.get_rotation_speed(lander_id) },
+            { "thrust"        , rocket.get_thrust()      , ensemble.get_thrust(lander_id)       },
+            { "fuel"          , rocket.get_fuel()        , ensemble.get_fuel(lander_id)         },
+            { "hydrazine"     , rocket.get_hydrazine()   , ensemble.get_hydrazine(lander_id)    },
+        };
+
+        bool is_matching = true;
+        for (const Field &field : fields)
+        {
+            if (!is_equal(field.expected, field.actual))
+            {
+                std::cerr << "lander " << lander_id << ", step " << step << ": " << field.name << " is "
+                          << field.actual << ", expected " << field.expected << '\n';
+                is_matching = false;
+            }
+        }
+
+        if (rocket.get_engine_mode() != ensemble.get_engine_mode(lander_id))
+        {
+            std::cerr << "lander " << lander_id << ", step " << step << ": engine mode differs\n";
+            is_matching = false;
+        }
+        if (rocket.get_rcs_mode() != ensemble.get_rcs_mode(lander_id))
+        {
+            std::cerr << "lander " << lander_id << ", step " << step << ": RCS mode differs\n";
+            is_matching = false;
+        }
+        return is_matching;
+    }
+
+    // Changes the controls of a lander now and then, the same way for both
+    void drive(std::mt19937 &random, Rocket &rocket, RocketEnsemble &ensemble, size_t lander_id)
+    {
+        static constexpr Rocket::EngineMode Engine_modes[] = {
+            Rocket::EngineMode::IDLE, Rocket::EngineMode::INCREASE_THRUST, Rocket::EngineMode::DECREASE_THRUST,
+            Rocket::EngineMode::SET_MAX_THRUST, Rocket::EngineMode::SET_NO_THRUST
+        };
+        static constexpr Rocket::RcsEngineMode Rcs_modes[] = {
+            Rocket::RcsEngineMode::CW, Rocket::RcsEngineMode::CCW, Rocket::RcsEngineMode::IDLE,
+            Rocket::RcsEngineMode::STABILIZE, Rocket::RcsEngineMode::PREV_PASSIVE_MODE
+        };
+
+        switch (random() % 16)
+        {
+            case 0:
+            {
+                Rocket::EngineMode mode = Engine_modes[random() % std::size(Engine_modes)];
+                rocket.toggle_engine(mode);
+                ensemble.toggle_engine(lander_id, mode);
+                break;
+            }
+            case 1:
+            {
+                Rocket::RcsEngineMode mode = Rcs_modes[random() % std::size(Rcs_modes)];
+                rocket.toggle_rcs(mode);
+                ensemble.toggle_rcs(lander_id, mode);
+                break;
+            }
+            case 2:
+            {
+                rocket.switch_rcs_stabilization_mode();
+                ensemble.switch_rcs_stabilization_mode(lander_id);
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+}
+
+int main()
+{
+#ifdef __AVX__
+    if (!__builtin_cpu_supports("avx"))
+    {
+        std::cout << "No AVX on this CPU, skipped\n";
+        return Skip_code;
+    }
+#endif
+
+    // Mismatches are in the last bits
+    std::cerr.precision(17);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> position(0, 1000);
+    std::uniform_real_distribution<double> step_time(Min_dt, Max_dt);
+
+    // Rockets are big, keep them on the heap
+    RocketEnsemble ensemble;
+    std::vector<std::unique_ptr<Rocket>> rockets;
+    for (size_t i = 0; i < Landers_count; ++i)
+    {
+        rockets.push_back(std::make_unique<Rocket>(Vector2d(50, 80)));
+        rockets.back()->set_position(position(random), position(random));
+
+        // Takes the position back, moving the rocket may round it
+        ensemble.add(rockets.back()->get_position());
+    }
+
+    for (size_t step = 0; step < Steps_count; ++step)
+    {
+        for (size_t lander_id = 0; lander_id < Landers_count; ++lander_id)
+            drive(random, *rockets[lander_id], ensemble, lander_id);
+
+        double dt = step_time(random);
+        for (std::unique_ptr<Rocket> &rocket : rockets)
+            rocket->update(dt);
+        ensemble.update(dt);
+
+        for (size_t lander_id = 0; lander_id < Landers_count; ++lander_id)
+        {
+            if (!compare(*rockets[lander_id], ensemble, lander_id, step))
+                return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << Landers_count << " landers match Rocket in " << Steps_count << " steps with "
+              << RocketEnsemble::Lanes_count << " lanes\n";
+    return EXIT_SUCCESS;
+}